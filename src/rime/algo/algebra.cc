@@ -6,6 +6,8 @@
 //
 #include <algorithm>
 #include <fstream>
+#include <iterator>
+#include <utf8.h>
 #include <rime/algo/algebra.h>
 #include <rime/algo/calculus.h>
 
@@ -55,6 +57,8 @@ bool Projection::Load(an<ConfigList> settings) {
   if (!settings)
     return false;
   calculation_.clear();
+  formulas_.clear();
+  memo_.clear();
   Calculus calc;
   bool success = true;
   for (size_t i = 0; i < settings->size(); ++i) {
@@ -78,16 +82,90 @@ bool Projection::Load(an<ConfigList> settings) {
       break;
     }
     calculation_.push_back(x);
+    formulas_ += formula + '\n';
   }
   if (!success) {
     calculation_.clear();
+    formulas_.clear();
   }
+  CombineTransliterations();
   return success;
 }
 
+void Projection::CombineTransliterations() {
+  xlit_only_ = !calculation_.empty();
+  xlit_table_.clear();
+  set<uint32_t> chars;
+  for (const auto& x : calculation_) {
+    auto xlit = dynamic_cast<Transliteration*>(x.get());
+    if (!xlit) {
+      xlit_only_ = false;
+      return;
+    }
+    for (const auto& m : xlit->char_map()) {
+      chars.insert(m.first);
+    }
+  }
+  for (uint32_t c : chars) {
+    uint32_t result = c;
+    for (const auto& x : calculation_) {
+      const auto& char_map =
+          static_cast<Transliteration*>(x.get())->char_map();
+      auto found = char_map.find(result);
+      if (found != char_map.end()) {
+        result = found->second;
+      }
+    }
+    xlit_table_[c] = result;
+  }
+}
+
 bool Projection::Apply(string* value) {
   if (!value || value->empty())
     return false;
+  if (!memo_capacity_)
+    return Calculate(value);
+  auto found = memo_.find(*value);
+  if (found != memo_.end()) {
+    if (found->second.first)
+      value->assign(found->second.second);
+    return found->second.first;
+  }
+  if (memo_.size() >= memo_capacity_) {
+    memo_.clear();
+  }
+  auto& result = memo_[*value];
+  result.first = Calculate(value);
+  if (result.first)
+    result.second = *value;
+  return result.first;
+}
+
+bool Projection::Transliterate(string* value) {
+  string result;
+  result.reserve(value->length());
+  bool modified = false;
+  const char* p = value->c_str();
+  uint32_t c;
+  while ((c = utf8::unchecked::next(p))) {
+    auto found = xlit_table_.find(c);
+    if (found != xlit_table_.end()) {
+      c = found->second;
+      modified = true;
+    }
+    utf8::unchecked::append(c, std::back_inserter(result));
+  }
+  if (modified)
+    value->swap(result);
+  return modified;
+}
+
+bool Projection::Calculate(string* value) {
+  // Transliteration::Apply gives up on strings that might overflow its
+  // buffer; leave those to the chain of calculations.
+  const size_t kMaxTransliterationLength = 63;
+  if (xlit_only_ && value->length() <= kMaxTransliterationLength)
+    return Transliterate(value);
   bool modified = false;
   Spelling s(*value);
   for (an<Calculation>& x : calculation_) {
@@ -28,14 +28,37 @@ class Script : public map<string, vector<Spelling>> {
 
 class Projection {
  public:
+  static constexpr size_t kDefaultMemoCapacity = 1024;
+
   RIME_DLL bool Load(an<ConfigList> settings);
   // "spelling" -> "gnilleps"
   RIME_DLL bool Apply(string* value);
   // {z, y, x} -> {a, b, c, d}
   RIME_DLL bool Apply(Script* value);
 
+  // remembers results of Apply(string*), for formatters applied to the same
+  // strings over and over.
+  void EnableMemo(size_t capacity = kDefaultMemoCapacity) {
+    memo_capacity_ = capacity;
+  }
+
+  // the loaded formulas, one per line; projections of equal formulas give
+  // equal results.
+  const string& formulas() const { return formulas_; }
+
  protected:
+  bool Calculate(string* value);
+  void CombineTransliterations();
+  bool Transliterate(string* value);
+
   vector<of<Calculation>> calculation_;
+  string formulas_;
+  // if all formulas are xlit, they are combined into one mapping of
+  // characters to transliterate strings in a single pass.
+  bool xlit_only_ = false;
+  hash_map<uint32_t, uint32_t> xlit_table_;
+  size_t memo_capacity_ = 0;
+  hash_map<string, pair<bool, string>> memo_;
 };
 
 }  // namespace rime
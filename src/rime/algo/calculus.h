@@ -42,6 +42,7 @@ class Transliteration : public Calculation {
  public:
   static Factory Parse;
   bool Apply(Spelling* spelling) override;
+  const map<uint32_t, uint32_t>& char_map() const { return char_map_; }
 
  protected:
   map<uint32_t, uint32_t> char_map_;
@@ -1,8 +1,10 @@
 #ifndef RIME_STRINGS_H_
 #define RIME_STRINGS_H_
 
-#include <rime/common.h>
+#include <stdint.h>
 #include <initializer_list>
+#include <rime_api.h>
+#include <rime/common.h>
 
 namespace rime {
 namespace strings {
@@ -39,6 +41,11 @@ inline string join(std::initializer_list<C>&& container, T&& delim) {
   return join(std::begin(container), std::end(container), delim);
 }
 
+// characters of CJK extensions and compatibility blocks, not in the basic
+// charset.
+RIME_DLL bool is_extended_cjk(uint32_t ch);
+RIME_DLL bool contains_extended_cjk(const string& text);
+
 }  // namespace strings
 }  // namespace rime
 
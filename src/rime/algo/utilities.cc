@@ -46,6 +46,45 @@ void ChecksumComputer::ProcessFile(const path& file_path) {
   }
 }
 
+// CRC is linear over GF(2): the remainder after some content equals the
+// remainder after as many zero bytes, starting from the same remainder,
+// xor the remainder after the content starting from 0. the former is a
+// linear map on 32-bit remainders, raised to the power of content length.
+using Gf2Matrix = std::array<uint32_t, 32>;  // column i is the image of bit i
+
+static uint32_t gf2_times(const Gf2Matrix& m, uint32_t v) {
+  uint32_t result = 0;
+  for (int i = 0; v; ++i, v >>= 1) {
+    if (v & 1)
+      result ^= m[i];
+  }
+  return result;
+}
+
+static Gf2Matrix gf2_square(const Gf2Matrix& m) {
+  Gf2Matrix result;
+  for (int i = 0; i < 32; ++i) {
+    result[i] = gf2_times(m, m[i]);
+  }
+  return result;
+}
+
+void ChecksumComputer::ProcessContent(uint32_t content_remainder,
+                                      uintmax_t length) {
+  Gf2Matrix zero_byte;
+  for (int i = 0; i < 32; ++i) {
+    boost::crc_32_type crc(uint32_t(1) << i);
+    crc.process_byte(0);
+    zero_byte[i] = crc.get_interim_remainder();
+  }
+  uint32_t remainder = crc_.get_interim_remainder();
+  for (; length; length >>= 1, zero_byte = gf2_square(zero_byte)) {
+    if (length & 1)
+      remainder = gf2_times(zero_byte, remainder);
+  }
+  crc_.reset(remainder ^ content_remainder);
+}
+
 uint32_t ChecksumComputer::Checksum() {
   return crc_.checksum();
 }
@@ -19,6 +19,10 @@ class ChecksumComputer {
  public:
   explicit ChecksumComputer(uint32_t initial_remainder = 0);
   void ProcessFile(const path& file_path);
+  // advances the checksum past `length` bytes of content which, processed
+  // from remainder 0, leaves the interim remainder `content_remainder`;
+  // for content hashed before, eg. of an unmodified file.
+  void ProcessContent(uint32_t content_remainder, uintmax_t length);
   uint32_t Checksum();
 
  private:
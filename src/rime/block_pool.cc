@@ -0,0 +1,105 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <new>
+#include <rime/block_pool.h>
+
+namespace rime {
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+constexpr size_t kNumSizeClasses =
+    BlockPool::kMaxBlockSize / BlockPool::kAlignment;
+
+inline size_t size_class(size_t size) {
+  return (size + BlockPool::kAlignment - 1) / BlockPool::kAlignment - 1;
+}
+
+inline size_t block_size(size_t size_class) {
+  return (size_class + 1) * BlockPool::kAlignment;
+}
+
+// trivially destructible, hence still usable by objects freed during the
+// destruction of the thread's other objects.
+struct FreeLists {
+  FreeBlock* heads[kNumSizeClasses];
+  size_t counts[kNumSizeClasses];
+  bool retired;
+};
+
+thread_local FreeLists free_lists;
+thread_local BlockPool::Stats thread_stats;
+
+// returns cached blocks to the heap when the thread exits.
+struct FreeListsReclaimer {
+  ~FreeListsReclaimer() {
+    BlockPool::Trim();
+    free_lists.retired = true;
+  }
+};
+
+}  // namespace
+
+void* BlockPool::Allocate(size_t size) {
+  ++thread_stats.allocations;
+  if (size == 0 || size > kMaxBlockSize) {
+    ++thread_stats.heap_allocations;
+    return ::operator new(size);
+  }
+  size_t k = size_class(size);
+  if (FreeBlock* block = free_lists.heads[k]) {
+    free_lists.heads[k] = block->next;
+    --free_lists.counts[k];
+    return block;
+  }
+  ++thread_stats.heap_allocations;
+  return ::operator new(block_size(k));
+}
+
+void BlockPool::Deallocate(void* block, size_t size) {
+  if (size == 0 || size > kMaxBlockSize || free_lists.retired) {
+    ::operator delete(block);
+    return;
+  }
+  static thread_local FreeListsReclaimer reclaimer;
+  (void)reclaimer;
+  size_t k = size_class(size);
+  if (free_lists.counts[k] >= kMaxFreeBytes / block_size(k)) {
+    ::operator delete(block);
+    return;
+  }
+  auto free_block = static_cast<FreeBlock*>(block);
+  free_block->next = free_lists.heads[k];
+  free_lists.heads[k] = free_block;
+  ++free_lists.counts[k];
+}
+
+void BlockPool::Trim() {
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    while (FreeBlock* block = free_lists.heads[i]) {
+      free_lists.heads[i] = block->next;
+      ::operator delete(block);
+    }
+    free_lists.counts[i] = 0;
+  }
+}
+
+size_t BlockPool::free_bytes() {
+  size_t bytes = 0;
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    bytes += free_lists.counts[i] * block_size(i);
+  }
+  return bytes;
+}
+
+const BlockPool::Stats& BlockPool::stats() {
+  return thread_stats;
+}
+
+}  // namespace rime
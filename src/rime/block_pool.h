@@ -0,0 +1,80 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_BLOCK_POOL_H_
+#define RIME_BLOCK_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <rime_api.h>
+
+namespace rime {
+
+// Recycles small blocks of memory, so that candidates and dictionary entries
+// created for a keystroke reuse the blocks of those dropped with the menu of
+// the previous keystroke. Only objects made with NewPooled<> use the pool.
+// Freed blocks are kept in free lists of the thread that frees them, up to a
+// limited size per size class; larger blocks come from the global heap.
+// A thread thus keeps up to kMaxFreeBytes for each of the 32 size classes,
+// 2 MiB at most, until it exits or calls Trim(). Context::Clear() trims the
+// pool once the composition is done with.
+class BlockPool {
+ public:
+  static constexpr size_t kAlignment = 16;
+  static constexpr size_t kMaxBlockSize = 512;
+  // bytes kept in the free list of each size class, per thread.
+  static constexpr size_t kMaxFreeBytes = 64 << 10;
+
+  struct Stats {
+    size_t allocations = 0;
+    // allocations not served from free lists.
+    size_t heap_allocations = 0;
+  };
+
+  RIME_DLL static void* Allocate(size_t size);
+  RIME_DLL static void Deallocate(void* block, size_t size);
+  // returns blocks in the free lists of the calling thread to the heap.
+  RIME_DLL static void Trim();
+  // bytes kept in the free lists of the calling thread.
+  RIME_DLL static size_t free_bytes();
+  // counts allocations made by the calling thread.
+  RIME_DLL static const Stats& stats();
+};
+
+template <class T>
+struct PoolAllocator {
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template <class U>
+  PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(BlockPool::Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) { BlockPool::Deallocate(p, n * sizeof(T)); }
+
+  template <class U>
+  bool operator==(const PoolAllocator<U>&) const {
+    return true;
+  }
+  template <class U>
+  bool operator!=(const PoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+// makes candidates and dictionary entries, which are created in numbers for
+// every keystroke and live no longer than a menu.
+template <class T, class... Args>
+inline std::shared_ptr<T> NewPooled(Args&&... args) {
+  return std::allocate_shared<T>(PoolAllocator<T>(),
+                                 std::forward<Args>(args)...);
+}
+
+}  // namespace rime
+
+#endif  // RIME_BLOCK_POOL_H_
@@ -7,6 +7,7 @@
 #ifndef RIME_CANDIDATE_H_
 #define RIME_CANDIDATE_H_
 
+#include <rime/block_pool.h>
 #include <rime/common.h>
 
 namespace rime {
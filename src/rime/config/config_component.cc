@@ -89,28 +89,30 @@ bool Config::GetString(const string& path, string* value) {
 
 size_t Config::GetListSize(const string& path) {
   DLOG(INFO) << "read: " << path;
-  auto list = GetList(path);
+  auto list = As<ConfigList>(data_->Traverse(path));
   return list ? list->size() : 0;
 }
 
+// nodes handed out can be modified in place, hence copied from a shared tree.
+
 an<ConfigItem> Config::GetItem(const string& path) {
   DLOG(INFO) << "read: " << path;
-  return data_->Traverse(path);
+  return data_->TraverseForWrite(path);
 }
 
 an<ConfigValue> Config::GetValue(const string& path) {
   DLOG(INFO) << "read: " << path;
-  return As<ConfigValue>(data_->Traverse(path));
+  return As<ConfigValue>(data_->TraverseForWrite(path));
 }
 
 an<ConfigList> Config::GetList(const string& path) {
   DLOG(INFO) << "read: " << path;
-  return As<ConfigList>(data_->Traverse(path));
+  return As<ConfigList>(data_->TraverseForWrite(path));
 }
 
 an<ConfigMap> Config::GetMap(const string& path) {
   DLOG(INFO) << "read: " << path;
-  return As<ConfigMap>(data_->Traverse(path));
+  return As<ConfigMap>(data_->TraverseForWrite(path));
 }
 
 bool Config::SetBool(const string& path, bool value) {
@@ -138,7 +140,7 @@ bool Config::SetItem(const string& path, an<ConfigItem> item) {
 }
 
 an<ConfigItem> Config::GetItem() const {
-  return data_->root;
+  return data_->TraverseForWrite("");
 }
 
 void Config::SetItem(an<ConfigItem> item) {
@@ -181,6 +183,9 @@ Config* ConfigComponentBase::Create(const string& file_name) {
 
 an<ConfigData> ConfigComponentBase::GetConfigData(const string& file_name) {
   auto config_id = resource_resolver_->ToResourceId(file_name);
+  if (shared_cache_) {
+    return GetSharedConfigData(config_id);
+  }
   // keep a weak reference to the shared config data in the component
   weak<ConfigData>& wp(cache_[config_id]);
   if (wp.expired()) {  // create a new copy and load it
@@ -192,10 +197,58 @@ an<ConfigData> ConfigComponentBase::GetConfigData(const string& file_name) {
   return wp.lock();
 }
 
+static const size_t kMaxRecentSharedData = 4;
+
+an<ConfigData> ConfigComponentBase::GetSharedConfigData(
+    const string& config_id) {
+  std::error_code ec;
+  auto file_path = resource_resolver_->ResolvePath(config_id);
+  auto file_size = std::filesystem::file_size(file_path, ec);
+  if (ec)
+    file_size = 0;
+  auto last_write_time = std::filesystem::last_write_time(file_path, ec);
+  if (ec)
+    last_write_time = std::filesystem::file_time_type::min();
+  std::lock_guard<std::mutex> lock(shared_cache_mutex_);
+  SharedConfigData& shared(shared_cache_data_[config_id]);
+  auto data = shared.data.lock();
+  if (!data || shared.file_size != file_size ||
+      shared.last_write_time != last_write_time) {
+    DLOG(INFO) << "loading shared config data: " << config_id;
+    data = LoadConfig(config_id);
+    data->Freeze();
+    shared.data = data;
+    shared.file_size = file_size;
+    shared.last_write_time = last_write_time;
+    // forget the released ones.
+    for (auto it = shared_cache_data_.begin();
+         it != shared_cache_data_.end();) {
+      if (it->second.data.expired())
+        it = shared_cache_data_.erase(it);
+      else
+        ++it;
+    }
+  }
+  recent_shared_data_.remove(data);
+  recent_shared_data_.push_front(data);
+  if (recent_shared_data_.size() > kMaxRecentSharedData)
+    recent_shared_data_.pop_back();
+  // a view sharing the frozen tree, whose nodes are copied before being
+  // modified.
+  auto view = New<ConfigData>(*data);
+  view->set_origin(data);
+  return view;
+}
+
 an<ConfigData> ConfigLoader::LoadConfig(ResourceResolver* resource_resolver,
                                         const string& config_id) {
   auto data = New<ConfigData>();
-  data->LoadFromFile(resource_resolver->ResolvePath(config_id), nullptr);
+  auto file_path = resource_resolver->ResolvePath(config_id);
+  // prefer the compiled image of deployed config files to parsing YAML.
+  if (auto_save_ || !data->LoadFromBinaryFile(
+                        ConfigData::BinaryFilePath(file_path), file_path)) {
+    data->LoadFromFile(file_path, nullptr);
+  }
   data->set_auto_save(auto_save_);
   return data;
 }
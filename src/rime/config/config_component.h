@@ -7,7 +7,9 @@
 #ifndef RIME_CONFIG_COMPONENT_H_
 #define RIME_CONFIG_COMPONENT_H_
 
+#include <cstdint>
 #include <iostream>
+#include <mutex>
 #include <type_traits>
 #include <rime/common.h>
 #include <rime/component.h>
@@ -96,13 +98,33 @@ class ConfigComponentBase : public Config::Component {
   RIME_DLL virtual ~ConfigComponentBase();
   RIME_DLL Config* Create(const string& file_name);
 
+  // when enabled, loaded config data is frozen and shared by the Config
+  // instances of the same config id, until the config file changes on disk.
+  // every Config instance gets its own copy-on-write view of the shared tree,
+  // so that changes made through one Config are not seen by the others.
+  // shared data is released once no Config uses it, save for the few most
+  // recently used ones.
+  void set_shared_cache(bool shared_cache) { shared_cache_ = shared_cache; }
+
  protected:
   virtual an<ConfigData> LoadConfig(const string& config_id) = 0;
   the<ResourceResolver> resource_resolver_;
 
  private:
   an<ConfigData> GetConfigData(const string& file_name);
+  an<ConfigData> GetSharedConfigData(const string& config_id);
   map<string, weak<ConfigData>> cache_;
+
+  struct SharedConfigData {
+    weak<ConfigData> data;
+    std::uintmax_t file_size = 0;
+    std::filesystem::file_time_type last_write_time;
+  };
+  map<string, SharedConfigData> shared_cache_data_;
+  // keeps the most recently used shared data alive, most recent first.
+  std::list<an<ConfigData>> recent_shared_data_;
+  std::mutex shared_cache_mutex_;
+  bool shared_cache_ = false;
 };
 
 template <class Loader, class ResourceProvider = ConfigResourceProvider>
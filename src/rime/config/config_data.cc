@@ -3,10 +3,14 @@
 // Distributed under the BSD License
 //
 #include <cctype>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <boost/algorithm/string.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <filesystem>
 #include <yaml-cpp/yaml.h>
 #include <rime/config/config_compiler.h>
@@ -21,6 +25,42 @@ an<ConfigItem> ConvertFromYaml(const YAML::Node& yaml_node,
 
 void EmitYaml(an<ConfigItem> node, YAML::Emitter* emitter, int depth);
 
+struct BinaryReader {
+  const char* ptr;
+  const char* end;
+  bool failed = false;
+
+  bool Fail() {
+    failed = true;
+    return false;
+  }
+  bool Read(char* tag) {
+    if (failed || end - ptr < 1)
+      return Fail();
+    *tag = *ptr++;
+    return true;
+  }
+  bool Read(uint32_t* number) {
+    if (failed || end - ptr < (ptrdiff_t)sizeof(uint32_t))
+      return Fail();
+    std::memcpy(number, ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+    return true;
+  }
+  bool Read(string* str) {
+    uint32_t length = 0;
+    if (!Read(&length) || end - ptr < (ptrdiff_t)length)
+      return Fail();
+    str->assign(ptr, length);
+    ptr += length;
+    return true;
+  }
+};
+
+an<ConfigItem> ConvertFromBinary(BinaryReader* reader);
+
+void EmitBinary(an<ConfigItem> node, std::ostream* out);
+
 ConfigData::~ConfigData() {
   if (auto_save_)
     Save();
@@ -95,6 +135,87 @@ bool ConfigData::SaveToFile(const path& file_path) {
   return SaveToStream(out);
 }
 
+// compiled config image: format header followed by the node tree in pre-order.
+// each node is a tag byte; scalars and map keys are length-prefixed strings,
+// lists and maps are prefixed with the number of child nodes.
+static const char kBinaryFormat[] = "Rime::Config/1.0";
+static const size_t kBinaryHeaderSize = 32;
+
+enum BinaryTag : char {
+  kBinaryNull = 'N',
+  kBinaryScalar = 'S',
+  kBinaryList = 'L',
+  kBinaryMap = 'M',
+};
+
+path ConfigData::BinaryFilePath(const path& file_path) {
+  path binary_file_path(file_path);
+  return binary_file_path.replace_extension(".bin");
+}
+
+bool ConfigData::LoadFromBinaryFile(const path& binary_file_path,
+                                    const path& file_path) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  auto binary_file_time = fs::last_write_time(binary_file_path, ec);
+  if (ec)
+    return false;
+  auto source_file_time = fs::last_write_time(file_path, ec);
+  if (ec || binary_file_time < source_file_time) {
+    // the image is stale unless built after the latest change to the source.
+    return false;
+  }
+  auto file_size = fs::file_size(binary_file_path, ec);
+  if (ec || file_size < kBinaryHeaderSize)
+    return false;
+  an<ConfigItem> loaded_root;
+  try {
+    using namespace boost::interprocess;
+    file_mapping file(binary_file_path.c_str(), read_only);
+    mapped_region region(file, read_only);
+    const char* data = static_cast<const char*>(region.get_address());
+    if (std::strncmp(data, kBinaryFormat, kBinaryHeaderSize) != 0) {
+      LOG(WARNING) << "unknown config image format: " << binary_file_path;
+      return false;
+    }
+    BinaryReader reader{data + kBinaryHeaderSize, data + region.get_size()};
+    loaded_root = ConvertFromBinary(&reader);
+    if (reader.failed) {
+      LOG(ERROR) << "corrupted config image: " << binary_file_path;
+      return false;
+    }
+  } catch (const boost::interprocess::interprocess_exception& e) {
+    LOG(ERROR) << "Error mapping config image \"" << binary_file_path
+               << "\" : " << e.what();
+    return false;
+  }
+  LOG(INFO) << "loaded config image '" << binary_file_path << "'.";
+  // update status
+  file_path_ = file_path;
+  modified_ = false;
+  root = loaded_root;
+  return true;
+}
+
+bool ConfigData::SaveToBinaryFile(const path& binary_file_path) {
+  if (binary_file_path.empty()) {
+    return false;
+  }
+  LOG(INFO) << "saving config image '" << binary_file_path << "'.";
+  std::ofstream out(binary_file_path.c_str(),
+                    std::ios::binary | std::ios::trunc);
+  if (!out.good()) {
+    LOG(ERROR) << "failed to save config image '" << binary_file_path << "'.";
+    return false;
+  }
+  char header[kBinaryHeaderSize] = {0};
+  std::strncpy(header, kBinaryFormat, kBinaryHeaderSize - 1);
+  out.write(header, kBinaryHeaderSize);
+  EmitBinary(root, &out);
+  out.close();
+  return !out.fail();
+}
+
 bool ConfigData::IsListItemReference(const string& key) {
   return key.length() > 1 && key[0] == '@' && std::isalnum(key[1]);
 }
@@ -210,6 +331,87 @@ bool ConfigData::TraverseWrite(const string& node_path, an<ConfigItem> item) {
   }
 }
 
+static void freeze(const an<ConfigItem>& item) {
+  if (!item || item->frozen())
+    return;
+  item->Freeze();
+  if (auto list = As<ConfigList>(item)) {
+    for (auto it = list->begin(); it != list->end(); ++it) {
+      freeze(*it);
+    }
+  } else if (auto map = As<ConfigMap>(item)) {
+    for (auto it = map->begin(); it != map->end(); ++it) {
+      freeze(it->second);
+    }
+  }
+}
+
+void ConfigData::Freeze() {
+  freeze(root);
+  frozen_ = true;
+}
+
+// returns an unfrozen copy of a frozen node, sharing its children.
+static an<ConfigItem> unfreeze(const an<ConfigItem>& item) {
+  if (!item || !item->frozen())
+    return item;
+  switch (item->type()) {
+    case ConfigItem::kScalar:
+      return New<ConfigValue>(*As<ConfigValue>(item));
+    case ConfigItem::kList:
+      return New<ConfigList>(*As<ConfigList>(item));
+    case ConfigItem::kMap:
+      return New<ConfigMap>(*As<ConfigMap>(item));
+    default:
+      return New<ConfigItem>(*item);
+  }
+}
+
+// unfreezes the node and its descendants.
+static an<ConfigItem> thaw(const an<ConfigItem>& item) {
+  auto result = unfreeze(item);
+  if (auto list = As<ConfigList>(result)) {
+    for (auto it = list->begin(); it != list->end(); ++it) {
+      *it = thaw(*it);
+    }
+  } else if (auto map = As<ConfigMap>(result)) {
+    for (auto it = map->begin(); it != map->end(); ++it) {
+      it->second = thaw(it->second);
+    }
+  }
+  return result;
+}
+
+an<ConfigItem> ConfigData::TraverseForWrite(const string& node_path) {
+  // nothing is copied for a missing node.
+  auto item = Traverse(node_path);
+  if (!frozen_ || !item)
+    return item;
+  if (node_path.empty() || node_path == "/") {
+    // no frozen node is left in the tree.
+    frozen_ = false;
+    return root = thaw(root);
+  }
+  root = unfreeze(root);
+  an<ConfigItem> p = root;
+  vector<string> keys = SplitPath(node_path);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto& key = keys[i];
+    bool is_last = i + 1 == keys.size();
+    if (IsListItemReference(key)) {
+      auto list = As<ConfigList>(p);
+      size_t index = ResolveListIndex(p, key, true);
+      p = is_last ? thaw(list->GetAt(index)) : unfreeze(list->GetAt(index));
+      list->SetAt(index, p);
+    } else {
+      auto map = As<ConfigMap>(p);
+      p = is_last ? thaw(map->Get(key)) : unfreeze(map->Get(key));
+      map->Set(key, p);
+    }
+  }
+  return p;
+}
+
 vector<string> ConfigData::SplitPath(const string& node_path) {
   vector<string> keys;
   auto is_separator = boost::is_any_of("/");
@@ -289,6 +491,87 @@ an<ConfigItem> ConvertFromYaml(const YAML::Node& node,
   return nullptr;
 }
 
+an<ConfigItem> ConvertFromBinary(BinaryReader* reader) {
+  char tag = kBinaryNull;
+  if (!reader->Read(&tag)) {
+    return nullptr;
+  }
+  if (tag == kBinaryScalar) {
+    string value;
+    if (!reader->Read(&value))
+      return nullptr;
+    return New<ConfigValue>(value);
+  }
+  uint32_t size = 0;
+  if (tag == kBinaryList) {
+    if (!reader->Read(&size))
+      return nullptr;
+    auto config_list = New<ConfigList>();
+    for (uint32_t i = 0; i < size && !reader->failed; ++i) {
+      config_list->Append(ConvertFromBinary(reader));
+    }
+    return config_list;
+  } else if (tag == kBinaryMap) {
+    if (!reader->Read(&size))
+      return nullptr;
+    auto config_map = New<ConfigMap>();
+    string key;
+    for (uint32_t i = 0; i < size && reader->Read(&key); ++i) {
+      config_map->Set(key, ConvertFromBinary(reader));
+    }
+    return config_map;
+  } else if (tag != kBinaryNull) {
+    reader->failed = true;
+  }
+  return nullptr;
+}
+
+static void WriteBinary(uint32_t number, std::ostream* out) {
+  out->write(reinterpret_cast<const char*>(&number), sizeof(number));
+}
+
+static void WriteBinary(const string& str, std::ostream* out) {
+  WriteBinary(static_cast<uint32_t>(str.length()), out);
+  out->write(str.data(), str.length());
+}
+
+static bool IsEmittedNode(const an<ConfigItem>& node) {
+  return node && node->type() != ConfigItem::kNull;
+}
+
+// omits null nodes in lists and maps, as does EmitYaml().
+void EmitBinary(an<ConfigItem> node, std::ostream* out) {
+  if (!IsEmittedNode(node)) {
+    out->put(kBinaryNull);
+  } else if (node->type() == ConfigItem::kScalar) {
+    out->put(kBinaryScalar);
+    WriteBinary(As<ConfigValue>(node)->str(), out);
+  } else if (node->type() == ConfigItem::kList) {
+    auto list = As<ConfigList>(node);
+    out->put(kBinaryList);
+    WriteBinary(static_cast<uint32_t>(std::count_if(
+                    list->begin(), list->end(), IsEmittedNode)),
+                out);
+    for (auto it = list->begin(), end = list->end(); it != end; ++it) {
+      if (IsEmittedNode(*it))
+        EmitBinary(*it, out);
+    }
+  } else if (node->type() == ConfigItem::kMap) {
+    auto map = As<ConfigMap>(node);
+    out->put(kBinaryMap);
+    WriteBinary(static_cast<uint32_t>(std::count_if(
+                    map->begin(), map->end(),
+                    [](const auto& kv) { return IsEmittedNode(kv.second); })),
+                out);
+    for (auto it = map->begin(), end = map->end(); it != end; ++it) {
+      if (!IsEmittedNode(it->second))
+        continue;
+      WriteBinary(it->first, out);
+      EmitBinary(it->second, out);
+    }
+  }
+}
+
 void EmitScalar(const string& str_value, YAML::Emitter* emitter) {
   if (str_value.find_first_of("\r\n") != string::npos) {
     *emitter << YAML::Literal;
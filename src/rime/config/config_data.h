@@ -17,6 +17,8 @@ class ConfigItem;
 class ConfigData {
  public:
   ConfigData() = default;
+  // the copy shares tree nodes with the original.
+  ConfigData(const ConfigData& other) = default;
   ~ConfigData();
 
   // returns whether actually saved to file.
@@ -25,11 +27,21 @@ class ConfigData {
   bool SaveToStream(std::ostream& stream);
   bool LoadFromFile(const path& file_path, ConfigCompiler* compiler);
   bool SaveToFile(const path& file_path);
+  // loads the compiled binary image of a config file; fails if the image is
+  // missing, malformed or older than the source file at file_path.
+  bool LoadFromBinaryFile(const path& binary_file_path, const path& file_path);
+  bool SaveToBinaryFile(const path& binary_file_path);
   bool TraverseWrite(const string& path, an<ConfigItem> item);
   an<ConfigItem> Traverse(const string& path);
+  // finds the node as Traverse() does, but first copies the frozen nodes on
+  // the path and in the subtree, so that the node can be modified in place.
+  an<ConfigItem> TraverseForWrite(const string& path);
+  // freezes the tree to be shared by copies of this config data.
+  void Freeze();
 
   static vector<string> SplitPath(const string& path);
   static string JoinPath(const vector<string>& keys);
+  static path BinaryFilePath(const path& file_path);
   static bool IsListItemReference(const string& key);
   static string FormatListIndex(size_t index);
   static size_t ResolveListIndex(an<ConfigItem> list,
@@ -40,6 +52,8 @@ class ConfigData {
   bool modified() const { return modified_; }
   void set_modified() { modified_ = true; }
   void set_auto_save(bool auto_save) { auto_save_ = auto_save; }
+  // keeps the frozen config data, whose tree is shared, alive.
+  void set_origin(an<ConfigData> origin) { origin_ = origin; }
 
   an<ConfigItem> root;
 
@@ -47,6 +61,9 @@ class ConfigData {
   path file_path_;
   bool modified_ = false;
   bool auto_save_ = false;
+  // whether the tree may contain frozen nodes.
+  bool frozen_ = false;
+  an<ConfigData> origin_;
 };
 
 }  // namespace rime
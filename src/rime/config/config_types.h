@@ -19,16 +19,24 @@ class ConfigItem {
   enum ValueType { kNull, kScalar, kList, kMap };
 
   ConfigItem() = default;  // null
+  // a copy is never frozen.
+  ConfigItem(const ConfigItem& other) : type_(other.type_) {}
   virtual ~ConfigItem() = default;
 
   ValueType type() const { return type_; }
 
   virtual bool empty() const { return type_ == kNull; }
 
+  // a frozen node is shared by the config data of several Config instances,
+  // and is copied before being handed out for modification.
+  bool frozen() const { return frozen_; }
+  void Freeze() { frozen_ = true; }
+
  protected:
   ConfigItem(ValueType type) : type_(type) {}
 
   ValueType type_ = kNull;
+  bool frozen_ = false;
 };
 
 class ConfigValue : public ConfigItem {
@@ -26,7 +26,16 @@ bool SaveOutputPlugin::ReviewCompileOutput(ConfigCompiler* compiler,
 bool SaveOutputPlugin::ReviewLinkOutput(ConfigCompiler* compiler,
                                         an<ConfigResource> resource) {
   auto file_path = resource_resolver_->ResolvePath(resource->resource_id);
-  return resource->data->SaveToFile(file_path);
+  if (!resource->data->SaveToFile(file_path)) {
+    return false;
+  }
+  // the compiled image is optional; loaders fall back to the YAML output.
+  auto binary_file_path = ConfigData::BinaryFilePath(file_path);
+  if (!resource->data->SaveToBinaryFile(binary_file_path)) {
+    LOG(WARNING) << "failed to save compiled config image for "
+                 << resource->resource_id;
+  }
+  return true;
 }
 
 }  // namespace rime
@@ -6,6 +6,7 @@
 //
 #include <algorithm>
 #include <utility>
+#include <rime/block_pool.h>
 #include <rime/candidate.h>
 #include <rime/context.h>
 #include <rime/menu.h>
@@ -107,6 +108,8 @@ void Context::Clear() {
   input_.clear();
   caret_pos_ = 0;
   composition_.clear();
+  // return the blocks of dropped candidates, kept for the next keystroke.
+  BlockPool::Trim();
   update_notifier_(this);
 }
 
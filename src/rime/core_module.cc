@@ -33,6 +33,7 @@ static void rime_core_initialize() {
 
   auto config_loader =
       new ConfigComponent<ConfigLoader, DeployedConfigResourceProvider>;
+  config_loader->set_shared_cache(true);
   r.Register("config", config_loader);
   r.Register("schema", new SchemaComponent(config_loader));
 
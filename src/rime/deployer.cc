@@ -6,6 +6,7 @@
 //
 #include <chrono>
 #include <exception>
+#include <filesystem>
 #include <utility>
 #include <rime/common.h>
 #include <rime/deployer.h>
@@ -96,6 +97,7 @@ bool Deployer::Run() {
     }
     LOG(INFO) << success + failure << " tasks ran: " << success << " success, "
               << failure << " failure.";
+    SaveFileManifest();
     message_sink_("deploy", !failure ? "success" : "failure");
     // new tasks could have been enqueued while we were sending the message.
     // before quitting, double check if there is nothing left to do.
@@ -151,4 +153,19 @@ path Deployer::user_data_sync_dir() const {
   return sync_dir / user_id;
 }
 
+static const char kFileManifestName[] = "file_manifest.txt";
+
+FileManifest& Deployer::file_manifest() {
+  std::call_once(file_manifest_loaded_, [this] {
+    file_manifest_.Load(staging_dir / kFileManifestName);
+  });
+  return file_manifest_;
+}
+
+void Deployer::SaveFileManifest() {
+  if (file_manifest_.modified() && std::filesystem::exists(staging_dir)) {
+    file_manifest_.Save(staging_dir / kFileManifestName);
+  }
+}
+
 }  // namespace rime
@@ -13,6 +13,7 @@
 #include <any>
 #include <rime/common.h>
 #include <rime/component.h>
+#include <rime/file_manifest.h>
 #include <rime/messenger.h>
 
 namespace rime {
@@ -67,11 +68,18 @@ class Deployer : public Messenger {
 
   path user_data_sync_dir() const;
 
+  // stamps of source files, loaded from the staging directory on first use
+  // and saved back after deployment tasks have run.
+  FileManifest& file_manifest();
+  void SaveFileManifest();
+
  private:
   std::queue<of<DeploymentTask>> pending_tasks_;
   std::mutex mutex_;
   std::future<void> work_;
   bool maintenance_mode_ = false;
+  FileManifest file_manifest_;
+  std::once_flag file_manifest_loaded_;
 };
 
 }  // namespace rime
@@ -7,6 +7,7 @@
 #ifndef RIME_DB_H_
 #define RIME_DB_H_
 
+#include <atomic>
 #include <rime_api.h>
 #include <rime/common.h>
 #include <rime/component.h>
@@ -63,13 +64,19 @@ class Db : public Class<Db, const string&> {
   bool disabled() const { return disabled_; }
   void disable() { disabled_ = true; }
   void enable() { disabled_ = false; }
+  // changes whenever records may have changed, written through any of the
+  // objects sharing the db.
+  size_t revision() const { return revision_; }
 
  protected:
+  void UpdateRevision() { ++revision_; }
+
   string name_;
   path file_path_;
   bool loaded_ = false;
   bool readonly_ = false;
   bool disabled_ = false;
+  std::atomic<size_t> revision_{0};
 };
 
 class Transactional {
@@ -4,10 +4,12 @@
 //
 // 2011-11-27 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <filesystem>
 #include <cfloat>
 #include <cmath>
 #include <fstream>
+#include <boost/crc.hpp>
 #include <rime/algo/algebra.h>
 #include <rime/algo/utilities.h>
 #include <rime/dict/corrector.h>
@@ -29,6 +31,7 @@ DictCompiler::DictCompiler(Dictionary* dictionary)
       packs_(dictionary->packs()),
       prism_(dictionary->prism()),
       tables_(dictionary->tables()),
+      merged_table_(dictionary->merged_table()),
       source_resolver_(
           Service::instance().CreateResourceResolver({"source_file", "", ""})),
       target_resolver_(Service::instance().CreateStagingResourceResolver(
@@ -67,12 +70,16 @@ static uint32_t compute_dict_file_checksum(uint32_t initial_checksum,
   if (dict_files.empty()) {
     return initial_checksum;
   }
-  ChecksumComputer cc(initial_checksum);
-  for (const auto& file_path : dict_files) {
-    cc.ProcessFile(file_path);
-  }
+  vector<path> files_to_hash(dict_files);
   if (settings.use_preset_vocabulary()) {
-    cc.ProcessFile(PresetVocabulary::DictFilePath(settings.vocabulary()));
+    files_to_hash.push_back(
+        PresetVocabulary::DictFilePath(settings.vocabulary()));
+  }
+  auto& manifest = Service::instance().deployer().file_manifest();
+  manifest.Prefetch(files_to_hash);
+  ChecksumComputer cc(initial_checksum);
+  for (const auto& file_path : files_to_hash) {
+    manifest.ProcessFile(file_path, &cc);
   }
   return cc.Checksum();
 }
@@ -96,8 +103,9 @@ bool DictCompiler::Compile(const path& schema_file) {
   }
   uint32_t dict_file_checksum =
       compute_dict_file_checksum(0, dict_files, settings);
+  auto& manifest = Service::instance().deployer().file_manifest();
   uint32_t schema_file_checksum =
-      schema_file.empty() ? 0 : Checksum(schema_file);
+      schema_file.empty() ? 0 : manifest.Checksum(schema_file);
   bool rebuild_table = false;
   bool rebuild_prism = false;
   const auto& primary_table = tables_[0];
@@ -203,6 +211,12 @@ bool DictCompiler::Compile(const path& schema_file) {
     syllabary = std::move(collector.syllabary);
     pack_table->Close();
   }
+  if (merged_table_ && !BuildMergedTable()) {
+    LOG(ERROR) << "failed to merge packs into table: "
+               << merged_table_->file_path();
+    // look up words in the primary table and packs instead.
+    merged_table_->Remove();
+  }
   // done!
   return true;
 }
@@ -222,6 +236,8 @@ bool DictCompiler::BuildTable(int table_index,
   auto target_path =
       relocate_target(table->file_path(), target_resolver_.get());
   LOG(INFO) << "building table: " << target_path;
+  // do not keep the stale table in memory after it's rebuilt
+  Service::instance().retention().Release(table->file_path());
   table = New<Table>(target_path);
 
   collector.Configure(settings);
@@ -277,6 +293,133 @@ bool DictCompiler::BuildTable(int table_index,
   return true;
 }
 
+using MergedEntries = map<Code, vector<ShortDictEntryList>>;
+
+static void collect_entries(MergedEntries* merged_entries,
+                            size_t table_index,
+                            Table* table,
+                            TableAccessor accessor) {
+  for (; !accessor.exhausted(); accessor.Next()) {
+    auto e = New<ShortDictEntry>();
+    e->code = accessor.code();
+    e->text = table->GetEntryText(*accessor.entry());
+    e->weight = accessor.entry()->weight;
+    auto& lists = (*merged_entries)[e->code];
+    lists.resize(table_index + 1);
+    lists[table_index].push_back(e);
+  }
+}
+
+static void collect_entries(MergedEntries* merged_entries,
+                            size_t table_index,
+                            Table* table,
+                            TableQuery* query) {
+  SyllableId num_syllables = table->metadata()->num_syllables;
+  for (SyllableId syllable_id = 0; syllable_id < num_syllables;
+       ++syllable_id) {
+    collect_entries(merged_entries, table_index, table,
+                    query->Access(syllable_id));
+    if (query->Advance(syllable_id)) {
+      if (query->level() < Code::kIndexCodeMaxLength) {
+        collect_entries(merged_entries, table_index, table, query);
+      } else {
+        // entries of longer codes are all stored in the tail index
+        collect_entries(merged_entries, table_index, table, query->Access(0));
+      }
+      query->Backdate();
+    }
+  }
+}
+
+// merges homophones from the tables in the order dictionary lookups would
+// yield them, by weight of the head entries.
+static size_t merge_entries(const MergedEntries& merged_entries,
+                            size_t num_syllables,
+                            Vocabulary* vocabulary) {
+  size_t num_entries = 0;
+  for (const auto& x : merged_entries) {
+    const Code& code = x.first;
+    if (std::any_of(code.begin(), code.end(), [=](SyllableId id) {
+          return id < 0 || id >= static_cast<SyllableId>(num_syllables);
+        })) {
+      LOG(WARNING) << "dropping entries of syllables unknown to the primary "
+                      "table.";
+      continue;
+    }
+    auto dest = vocabulary->LocateEntries(code);
+    if (!dest)
+      continue;
+    const auto& lists = x.second;
+    vector<size_t> cursors(lists.size());
+    while (true) {
+      size_t best = lists.size();
+      for (size_t i = 0; i < lists.size(); ++i) {
+        if (cursors[i] < lists[i].size() &&
+            (best == lists.size() || lists[i][cursors[i]]->weight >
+                                         lists[best][cursors[best]]->weight)) {
+          best = i;
+        }
+      }
+      if (best == lists.size())
+        break;
+      dest->push_back(lists[best][cursors[best]++]);
+      ++num_entries;
+    }
+  }
+  return num_entries;
+}
+
+bool DictCompiler::BuildMergedTable() {
+  vector<of<Table>> tables;
+  boost::crc_32_type crc;
+  for (const auto& table : tables_) {
+    if (table->Exists() && table->Load()) {
+      uint32_t checksum = table->dict_file_checksum();
+      crc.process_bytes(&checksum, sizeof(checksum));
+      tables.push_back(table);
+    } else if (tables.empty()) {
+      return false;  // missing primary table
+    }
+  }
+  uint32_t merged_checksum = crc.checksum();
+  bool rebuild = true;
+  if (merged_table_->Exists() && merged_table_->Load()) {
+    rebuild = merged_table_->dict_file_checksum() != merged_checksum ||
+              (options_ & kRebuildTable);
+    merged_table_->Close();
+  }
+  bool success = true;
+  if (rebuild) {
+    LOG(INFO) << "merging " << tables.size() << " tables.";
+    auto target_path =
+        relocate_target(merged_table_->file_path(), target_resolver_.get());
+    Service::instance().retention().Release(merged_table_->file_path());
+    merged_table_ = New<Table>(target_path);
+    Syllabary syllabary;
+    MergedEntries merged_entries;
+    success = tables[0]->GetSyllabary(&syllabary);
+    for (size_t i = 0; success && i < tables.size(); ++i) {
+      TableQuery query(tables[i]->metadata()->index.get());
+      collect_entries(&merged_entries, i, tables[i].get(), &query);
+    }
+    Vocabulary vocabulary;
+    size_t num_entries =
+        merge_entries(merged_entries, syllabary.size(), &vocabulary);
+    merged_table_->Remove();
+    success = success &&
+              merged_table_->Build(syllabary, vocabulary, num_entries,
+                                   merged_checksum) &&
+              merged_table_->Save();
+    merged_table_->Close();
+  } else {
+    LOG(INFO) << "merged table is up to date: " << merged_table_->file_path();
+  }
+  for (const auto& table : tables) {
+    table->Close();
+  }
+  return success;
+}
+
 bool DictCompiler::BuildReverseDb(DictSettings* settings,
                                   const EntryCollector& collector,
                                   const Vocabulary& vocabulary,
@@ -299,6 +442,7 @@ bool DictCompiler::BuildPrism(const path& schema_file,
   LOG(INFO) << "building prism...";
   auto target_path =
       relocate_target(prism_->file_path(), target_resolver_.get());
+  Service::instance().retention().Release(prism_->file_path());
   prism_ = New<Prism>(target_path);
 
   // get syllabary from primary table, which may not be rebuilt
@@ -50,12 +50,14 @@ class DictCompiler {
                       const EntryCollector& collector,
                       const Vocabulary& vocabulary,
                       uint32_t dict_file_checksum);
+  bool BuildMergedTable();
 
   const string& dict_name_;
   const vector<string>& packs_;
   an<Prism> prism_;
   an<EditDistanceCorrector> correction_;
   vector<of<Table>> tables_;
+  an<Table> merged_table_;
   int options_ = 0;
   the<ResourceResolver> source_resolver_;
   the<ResourceResolver> target_resolver_;
@@ -5,6 +5,7 @@
 // 2011-07-05 GONG Chen <chen.sst@gmail.com>
 //
 #include <filesystem>
+#include <rime/algo/strings.h>
 #include <rime/algo/syllabifier.h>
 #include <rime/common.h>
 #include <rime/dict/dictionary.h>
@@ -124,6 +125,50 @@ CodeMatch match_extra_code(const table::Code* extra_code,
 
 }  // namespace dictionary
 
+string DictEntryView::text() const {
+  return chunk_.table->GetEntryText(chunk_.entries[chunk_.cursor]);
+}
+
+bool DictEntryView::text_flags(uint8_t* flags) const {
+  return chunk_.table->GetEntryTextFlags(chunk_.entries[chunk_.cursor], flags);
+}
+
+bool DictEntryView::has_extended_cjk() const {
+  uint8_t flags;
+  if (text_flags(&flags))
+    return flags & table::kExtendedCjk;
+  return strings::contains_extended_cjk(text());
+}
+
+double DictEntryView::weight() const {
+  const double kS = 18.420680743952367;  // log(1e8)
+  return chunk_.entries[chunk_.cursor].weight - kS + chunk_.credibility;
+}
+
+const Code& DictEntryView::code() const {
+  return chunk_.code;
+}
+
+size_t DictEntryView::remaining_code_length() const {
+  return chunk_.remaining_code.length();
+}
+
+an<DictEntry> DictEntryView::ToDictEntry() const {
+  auto entry = NewPooled<DictEntry>();
+  entry->code = chunk_.code;
+  entry->text = text();
+  entry->weight = weight();
+  entry->quality_len = chunk_.quality_len;
+  if (!chunk_.remaining_code.empty()) {
+    entry->comment = "~" + chunk_.remaining_code;
+    entry->remaining_code_length = chunk_.remaining_code.length();
+  }
+  if (chunk_.is_predictive_match()) {
+    entry->matching_code_size = chunk_.matching_code_size;
+  }
+  return entry;
+}
+
 DictEntryIterator::DictEntryIterator()
     : query_result_(New<dictionary::QueryResult>()) {}
 
@@ -144,36 +189,47 @@ void DictEntryIterator::AddFilter(DictEntryFilter filter) {
   DictEntryFilterBinder::AddFilter(filter);
   // the introduced filter could invalidate the current or even all the
   // remaining entries
-  while (!exhausted() && !filter_(Peek())) {
-    entry_.reset();
-    FindNextEntry();
+  SkipRejectedEntries();
+}
+
+void DictEntryIterator::AddViewFilter(DictEntryViewFilter filter) {
+  if (!view_filter_) {
+    view_filter_.swap(filter);
+  } else {
+    DictEntryViewFilter previous_filter(std::move(view_filter_));
+    view_filter_ = [previous_filter, filter](const DictEntryView& view) {
+      return previous_filter(view) && filter(view);
+    };
   }
+  SkipRejectedEntries();
 }
 
 an<DictEntry> DictEntryIterator::Peek() {
   if (!entry_ && !exhausted()) {
     // get next entry from current chunk
-    const auto& chunk = query_result_->chunks[chunk_index_];
-    const auto& e = chunk.entries[chunk.cursor];
-    DLOG(INFO) << "creating temporary dict entry '"
-               << chunk.table->GetEntryText(e) << "'.";
-    entry_ = New<DictEntry>();
-    entry_->code = chunk.code;
-    entry_->text = chunk.table->GetEntryText(e);
-    const double kS = 18.420680743952367;  // log(1e8)
-    entry_->weight = e.weight - kS + chunk.credibility;
-    entry_->quality_len = chunk.quality_len;
-    if (!chunk.remaining_code.empty()) {
-      entry_->comment = "~" + chunk.remaining_code;
-      entry_->remaining_code_length = chunk.remaining_code.length();
-    }
-    if (chunk.is_predictive_match()) {
-      entry_->matching_code_size = chunk.matching_code_size;
-    }
+    DLOG(INFO) << "creating temporary dict entry '" << PeekView().text()
+               << "'.";
+    entry_ = PeekView().ToDictEntry();
   }
   return entry_;
 }
 
+DictEntryView DictEntryIterator::PeekView() const {
+  return DictEntryView(query_result_->chunks[chunk_index_]);
+}
+
+bool DictEntryIterator::AcceptsCurrentEntry() {
+  return (!view_filter_ || view_filter_(PeekView())) &&
+         (!filter_ || filter_(Peek()));
+}
+
+void DictEntryIterator::SkipRejectedEntries() {
+  while (!exhausted() && !AcceptsCurrentEntry()) {
+    entry_.reset();
+    FindNextEntry();
+  }
+}
+
 bool DictEntryIterator::FindNextEntry() {
   if (exhausted()) {
     return false;
@@ -196,23 +252,24 @@ bool DictEntryIterator::Next() {
     if (!FindNextEntry()) {
       return false;
     }
-  } while (filter_ && !filter_(Peek()));
+  } while (!AcceptsCurrentEntry());
   return true;
 }
 
-// Note: does not apply filters
 bool DictEntryIterator::Skip(size_t num_entries) {
+  entry_.reset();
   while (num_entries > 0) {
     if (exhausted())
       return false;
     auto& chunk = query_result_->chunks[chunk_index_];
     if (chunk.cursor + num_entries < chunk.size) {
       chunk.cursor += num_entries;
-      return true;
+      break;
     }
     num_entries -= (chunk.size - chunk.cursor);
     ++chunk_index_;
   }
+  SkipRejectedEntries();
   return true;
 }
 
@@ -225,16 +282,33 @@ bool DictEntryIterator::exhausted() const {
 Dictionary::Dictionary(string name,
                        vector<string> packs,
                        vector<of<Table>> tables,
-                       an<Prism> prism)
+                       an<Prism> prism,
+                       an<Table> merged_table)
     : name_(name),
       packs_(std::move(packs)),
       tables_(std::move(tables)),
-      prism_(std::move(prism)) {}
+      prism_(std::move(prism)),
+      merged_table_(std::move(merged_table)),
+      lookup_tables_(tables_) {}
 
 Dictionary::~Dictionary() {
   // should not close shared table and prism objects
 }
 
+static void add_view_filters(DictEntryIterator& iter,
+                             const hash_set<string>* blacklist,
+                             bool filter_by_charset) {
+  if (blacklist && !blacklist->empty()) {
+    iter.AddViewFilter([blacklist](const DictEntryView& view) {
+      return !blacklist->count(view.text());
+    });
+  }
+  if (filter_by_charset) {
+    iter.AddViewFilter(
+        [](const DictEntryView& view) { return !view.has_extended_cjk(); });
+  }
+}
+
 static void lookup_table(Table* table,
                          DictEntryCollector* collector,
                          const SyllableGraph& syllable_graph,
@@ -272,11 +346,12 @@ an<DictEntryCollector> Dictionary::Lookup(const SyllableGraph& syllable_graph,
                                           size_t start_pos,
                                           const hash_set<string>* blacklist,
                                           bool predict_word,
-                                          double initial_credibility) {
+                                          double initial_credibility,
+                                          bool filter_by_charset) {
   if (!loaded())
     return nullptr;
   auto collector = New<DictEntryCollector>();
-  for (const auto& table : tables_) {
+  for (const auto& table : lookup_tables_) {
     if (!table->IsOpen())
       continue;
     lookup_table(table.get(), collector.get(), syllable_graph, start_pos,
@@ -285,14 +360,17 @@ an<DictEntryCollector> Dictionary::Lookup(const SyllableGraph& syllable_graph,
   if (collector->empty())
     return nullptr;
   // for each group of equal code length, sort it and filter words
-  for (auto& v : *collector) {
-    v.second.Sort();
-    if (blacklist && !blacklist->empty()) {
-      v.second.AddFilter([blacklist](an<DictEntry> entry) {
-        return entry && !blacklist->count(entry->text);
-      });
-    }
+  for (auto it = collector->begin(); it != collector->end();) {
+    it->second.Sort();
+    add_view_filters(it->second, blacklist, filter_by_charset);
+    // drop the group if all words are filtered out.
+    if (it->second.exhausted())
+      it = collector->erase(it);
+    else
+      ++it;
   }
+  if (collector->empty())
+    return nullptr;
   return collector;
 }
 
@@ -300,7 +378,8 @@ size_t Dictionary::LookupWords(DictEntryIterator* result,
                                const string& str_code,
                                bool predictive,
                                size_t expand_search_limit,
-                               const hash_set<string>* blacklist) {
+                               const hash_set<string>* blacklist,
+                               bool filter_by_charset) {
   DLOG(INFO) << "lookup: " << str_code;
   if (!loaded())
     return 0;
@@ -329,7 +408,7 @@ size_t Dictionary::LookupWords(DictEntryIterator* result,
         if (syllable.length() > code_length)
           remaining_code = syllable.substr(code_length);
       }
-      for (const auto& table : tables_) {
+      for (const auto& table : lookup_tables_) {
         if (!table->IsOpen())
           continue;
         TableAccessor a = table->QueryWords(syllable_id);
@@ -340,11 +419,7 @@ size_t Dictionary::LookupWords(DictEntryIterator* result,
       }
     }
   }
-  if (blacklist && !blacklist->empty()) {
-    result->AddFilter([blacklist](an<DictEntry> entry) {
-      return entry && !blacklist->count(entry->text);
-    });
-  }
+  add_view_filters(*result, blacklist, filter_by_charset);
   return keys.size();
 }
 
@@ -373,6 +448,9 @@ bool Dictionary::Remove() {
   for (const auto& table : tables_) {
     table->Remove();
   }
+  if (merged_table_) {
+    merged_table_->Remove();
+  }
   return true;
 }
 
@@ -392,6 +470,13 @@ bool Dictionary::Load() {
     LOG(ERROR) << "Error loading prism for dictionary '" << name_ << "'.";
     return false;
   }
+  if (merged_table_ && (merged_table_->IsOpen() ||
+                        (merged_table_->Exists() && merged_table_->Load()))) {
+    LOG(INFO) << "loaded merged table: " << merged_table_->file_path();
+    lookup_tables_ = {merged_table_};
+    return true;
+  }
+  lookup_tables_ = tables_;
   // packs are optional
   for (int i = 1; i < tables_.size(); ++i) {
     const auto& table = tables_[i];
@@ -447,34 +532,62 @@ Dictionary* DictionaryComponent::Create(const Ticket& ticket) {
       }
     }
   }
-  return Create(std::move(dict_name), std::move(prism_name), std::move(packs));
+  bool merge_packs = false;
+  config->GetBool(ticket.name_space + "/merge_packs", &merge_packs);
+  return Create(std::move(dict_name), std::move(prism_name), std::move(packs),
+                merge_packs);
 }
 
 Dictionary* DictionaryComponent::Create(string dict_name,
                                         string prism_name,
-                                        vector<string> packs) {
+                                        vector<string> packs,
+                                        bool merge_packs) {
   // obtain prism and primary table objects
-  auto primary_table = table_map_[dict_name].lock();
-  if (!primary_table) {
-    auto file_path = table_resource_resolver_->ResolvePath(dict_name);
-    table_map_[dict_name] = primary_table = New<Table>(file_path);
+  vector<of<Table>> tables = {GetTable(dict_name)};
+  for (const auto& pack : packs) {
+    tables.push_back(GetTable(pack));
+  }
+  an<Table> merged_table;
+  if (merge_packs && !packs.empty()) {
+    // eg. luna_pinyin+extra_words.table.bin
+    string merged_table_name = dict_name;
+    for (const auto& pack : packs) {
+      merged_table_name += "+" + pack;
+    }
+    merged_table = GetTable(merged_table_name);
+  }
+  auto prism = GetPrism(prism_name);
+  return new Dictionary(std::move(dict_name), std::move(packs),
+                        std::move(tables), std::move(prism),
+                        std::move(merged_table));
+}
+
+an<Table> DictionaryComponent::GetTable(const string& table_name) {
+  auto& retention = Service::instance().retention();
+  auto table = table_map_[table_name].lock();
+  if (table) {
+    retention.RecordLookup(table->file_path(), table.use_count());
+  } else {
+    auto file_path = table_resource_resolver_->ResolvePath(table_name);
+    retention.RecordLookup(file_path, 0);
+    table_map_[table_name] = table = New<Table>(file_path);
   }
+  retention.Retain(table, table->file_path());
+  return table;
+}
+
+an<Prism> DictionaryComponent::GetPrism(const string& prism_name) {
+  auto& retention = Service::instance().retention();
   auto prism = prism_map_[prism_name].lock();
-  if (!prism) {
+  if (prism) {
+    retention.RecordLookup(prism->file_path(), prism.use_count());
+  } else {
     auto file_path = prism_resource_resolver_->ResolvePath(prism_name);
+    retention.RecordLookup(file_path, 0);
     prism_map_[prism_name] = prism = New<Prism>(file_path);
   }
-  vector<of<Table>> tables = {std::move(primary_table)};
-  for (const auto& pack : packs) {
-    auto table = table_map_[pack].lock();
-    if (!table) {
-      auto file_path = table_resource_resolver_->ResolvePath(pack);
-      table_map_[pack] = table = New<Table>(file_path);
-    }
-    tables.push_back(std::move(table));
-  }
-  return new Dictionary(std::move(dict_name), std::move(packs),
-                        std::move(tables), std::move(prism));
+  retention.Retain(prism, prism->file_path());
+  return prism;
 }
 
 }  // namespace rime
@@ -23,6 +23,30 @@ struct QueryResult;
 
 }  // namespace dictionary
 
+// Refers to the entry at the cursor of a DictEntryIterator in the mapped
+// table, to test it before making a DictEntry of it. Invalidated as soon as
+// the iterator moves.
+class RIME_DLL DictEntryView {
+ public:
+  explicit DictEntryView(const dictionary::Chunk& chunk) : chunk_(chunk) {}
+
+  string text() const;
+  // returns false if flags of the text are not found in the table.
+  bool text_flags(uint8_t* flags) const;
+  // whether the text has characters of CJK extensions beyond the basic
+  // charset, told by the flags of the text if found in the table.
+  bool has_extended_cjk() const;
+  double weight() const;
+  const Code& code() const;
+  size_t remaining_code_length() const;
+  an<DictEntry> ToDictEntry() const;
+
+ private:
+  const dictionary::Chunk& chunk_;
+};
+
+using DictEntryViewFilter = function<bool(const DictEntryView& view)>;
+
 class RIME_DLL DictEntryIterator : public DictEntryFilterBinder {
  public:
   DictEntryIterator();
@@ -35,20 +59,28 @@ class RIME_DLL DictEntryIterator : public DictEntryFilterBinder {
   void AddChunk(dictionary::Chunk&& chunk);
   void Sort();
   void AddFilter(DictEntryFilter filter) override;
+  // view filters are applied before any DictEntry is made for an entry.
+  void AddViewFilter(DictEntryViewFilter filter);
   an<DictEntry> Peek();
+  DictEntryView PeekView() const;
   bool Next();
+  // skips entries whether accepted by the filters or not, then stops at the
+  // next accepted one.
   bool Skip(size_t num_entries);
   bool exhausted() const;
   size_t entry_count() const { return entry_count_; }
 
  protected:
   bool FindNextEntry();
+  bool AcceptsCurrentEntry();
+  void SkipRejectedEntries();
 
  private:
   an<dictionary::QueryResult> query_result_;
   size_t chunk_index_ = 0;
   an<DictEntry> entry_ = nullptr;
   size_t entry_count_ = 0;
+  DictEntryViewFilter view_filter_;
 };
 
 using DictEntryCollector = map<size_t, DictEntryIterator>;
@@ -64,19 +96,23 @@ class Dictionary : public Class<Dictionary, const Ticket&> {
   RIME_DLL Dictionary(string name,
                       vector<string> packs,
                       vector<of<Table>> tables,
-                      an<Prism> prism);
+                      an<Prism> prism,
+                      an<Table> merged_table = nullptr);
   virtual ~Dictionary();
 
   bool Exists() const;
   RIME_DLL bool Remove();
   RIME_DLL bool Load();
 
+  // if filter_by_charset is true, entries of text with characters of CJK
+  // extensions are skipped before being made into DictEntry objects.
   RIME_DLL an<DictEntryCollector> Lookup(
       const SyllableGraph& syllable_graph,
       size_t start_pos,
       const hash_set<string>* blacklist = nullptr,
       bool predict_word = false,
-      double initial_credibility = 0.0);
+      double initial_credibility = 0.0,
+      bool filter_by_charset = false);
   // if predictive is true, do an expand search with limit,
   // otherwise do an exact match.
   // return num of matching keys.
@@ -84,7 +120,8 @@ class Dictionary : public Class<Dictionary, const Ticket&> {
                               const string& str_code,
                               bool predictive,
                               size_t limit = 0,
-                              const hash_set<string>* blacklist = nullptr);
+                              const hash_set<string>* blacklist = nullptr,
+                              bool filter_by_charset = false);
   // translate syllable id sequence to string code
   RIME_DLL bool Decode(const Code& code, vector<string>* result);
 
@@ -95,12 +132,19 @@ class Dictionary : public Class<Dictionary, const Ticket&> {
   const vector<of<Table>>& tables() const { return tables_; }
   const an<Table>& primary_table() const { return tables_[0]; }
   const an<Prism>& prism() const { return prism_; }
+  // the primary table and packs merged into one, built at deployment if
+  // `merge_packs` is set for the dictionary.
+  const an<Table>& merged_table() const { return merged_table_; }
 
  private:
   string name_;
   vector<string> packs_;
   vector<of<Table>> tables_;
   an<Prism> prism_;
+  an<Table> merged_table_;
+  // tables to look words up in: the merged table once loaded, or else the
+  // primary table followed by packs.
+  vector<of<Table>> lookup_tables_;
 };
 
 class ResourceResolver;
@@ -110,9 +154,16 @@ class DictionaryComponent : public Dictionary::Component {
   DictionaryComponent();
   ~DictionaryComponent() override;
   Dictionary* Create(const Ticket& ticket) override;
-  Dictionary* Create(string dict_name, string prism_name, vector<string> packs);
+  Dictionary* Create(string dict_name,
+                     string prism_name,
+                     vector<string> packs,
+                     bool merge_packs = false);
 
  private:
+  // shares loaded objects among dictionaries, retaining recently used ones
+  an<Table> GetTable(const string& table_name);
+  an<Prism> GetPrism(const string& prism_name);
+
   map<string, weak<Prism>> prism_map_;
   map<string, weak<Table>> table_map_;
   the<ResourceResolver> prism_resource_resolver_;
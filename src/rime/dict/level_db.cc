@@ -180,6 +180,7 @@ bool LevelDb::Update(const string& key, const string& value) {
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "update db entry: " << key << " => " << value;
+  UpdateRevision();
   return db_->Update(key, value, in_transaction());
 }
 
@@ -187,6 +188,7 @@ bool LevelDb::Erase(const string& key) {
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "erase db entry: " << key;
+  UpdateRevision();
   return db_->Erase(key, in_transaction());
 }
 
@@ -246,6 +248,7 @@ bool LevelDb::Open() {
   readonly_ = false;
   auto status = db_->Open(file_path(), readonly_);
   loaded_ = status.ok();
+  UpdateRevision();
 
   if (loaded_) {
     string db_name;
@@ -268,6 +271,7 @@ bool LevelDb::OpenReadOnly() {
   readonly_ = true;
   auto status = db_->Open(file_path(), readonly_);
   loaded_ = status.ok();
+  UpdateRevision();
 
   if (!loaded_) {
     LOG(ERROR) << "Error opening db '" << name() << "' read-only.";
@@ -280,6 +284,7 @@ bool LevelDb::Close() {
     return false;
 
   db_->Release();
+  UpdateRevision();
 
   LOG(INFO) << "closed db '" << name() << "'.";
   loaded_ = false;
@@ -313,6 +318,7 @@ bool LevelDb::AbortTransaction() {
     return false;
   db_->ClearBatch();
   in_transaction_ = false;
+  UpdateRevision();
   return true;
 }
 
@@ -322,6 +328,7 @@ bool LevelDb::CommitTransaction() {
   bool ok = db_->CommitBatch();
   db_->ClearBatch();
   in_transaction_ = false;
+  UpdateRevision();
   return ok;
 }
 
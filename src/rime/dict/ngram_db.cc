@@ -0,0 +1,125 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <rime/dict/ngram_db.h>
+
+namespace rime {
+
+const char kNgramFormat[] = "Rime::Ngram/1.0";
+
+const char kNgramFormatPrefix[] = "Rime::Ngram/";
+const size_t kNgramFormatPrefixLen = sizeof(kNgramFormatPrefix) - 1;
+
+// log-probabilities below are clamped; 0.1 resolution suffices for ranking.
+const float kScoreMin = -25.5f;
+const float kScoreStep = 0.1f;
+
+NgramDb::NgramDb(const path& file_path) : MappedFile(file_path) {}
+
+bool NgramDb::Load() {
+  LOG(INFO) << "loading ngram db: " << file_path();
+
+  if (IsOpen())
+    Close();
+
+  if (!OpenReadOnly()) {
+    LOG(ERROR) << "Error opening ngram db '" << file_path() << "'.";
+    return false;
+  }
+
+  metadata_ = Find<ngram::Metadata>(0);
+  if (!metadata_) {
+    LOG(ERROR) << "metadata not found.";
+    Close();
+    return false;
+  }
+  if (strncmp(metadata_->format, kNgramFormatPrefix, kNgramFormatPrefixLen) ||
+      std::atoi(&metadata_->format[kNgramFormatPrefixLen]) != 1) {
+    LOG(ERROR) << "invalid metadata.";
+    Close();
+    return false;
+  }
+  size_t capacity = metadata_->keys.size;
+  if (capacity == 0 || (capacity & (capacity - 1)) ||
+      metadata_->scores.size != capacity) {
+    LOG(ERROR) << "invalid ngram table.";
+    Close();
+    return false;
+  }
+  keys_ = metadata_->keys.at.get();
+  scores_ = metadata_->scores.at.get();
+  mask_ = capacity - 1;
+  return true;
+}
+
+bool NgramDb::Build(const vector<pair<uint64_t, double>>& entries,
+                    uint32_t max_history_length) {
+  LOG(INFO) << "building ngram db...";
+  // at most half full, so that probing ends soon at an empty slot.
+  size_t capacity = 2;
+  while (capacity < entries.size() * 2)
+    capacity *= 2;
+
+  const size_t kReservedSize = 1024;
+  size_t estimated_data_size =
+      kReservedSize + capacity * (sizeof(uint64_t) + sizeof(uint8_t));
+  if (!Create(estimated_data_size)) {
+    LOG(ERROR) << "Error creating ngram db file '" << file_path() << "'.";
+    return false;
+  }
+  metadata_ = Allocate<ngram::Metadata>();
+  if (!metadata_) {
+    LOG(ERROR) << "Error creating metadata in file '" << file_path() << "'.";
+    return false;
+  }
+  auto keys = Allocate<uint64_t>(capacity);
+  auto scores = Allocate<uint8_t>(capacity);
+  if (!keys || !scores) {
+    LOG(ERROR) << "Error creating ngram table.";
+    return false;
+  }
+  uint64_t mask = capacity - 1;
+  size_t num_entries = 0;
+  for (const auto& entry : entries) {
+    uint64_t key = entry.first;
+    uint64_t i = key & mask;
+    while (keys[i] && keys[i] != key) {
+      i = (i + 1) & mask;
+    }
+    if (!keys[i])
+      ++num_entries;
+    keys[i] = key;
+    double q = std::round((entry.second - kScoreMin) / kScoreStep);
+    scores[i] = static_cast<uint8_t>((std::max)(0.0, (std::min)(255.0, q)));
+  }
+  metadata_->num_entries = num_entries;
+  metadata_->max_history_length = max_history_length;
+  metadata_->score_min = kScoreMin;
+  metadata_->score_step = kScoreStep;
+  metadata_->keys.size = capacity;
+  metadata_->keys.at = keys;
+  metadata_->scores.size = capacity;
+  metadata_->scores.at = scores;
+  keys_ = keys;
+  scores_ = scores;
+  mask_ = mask;
+
+  // at last, complete the metadata
+  std::strncpy(metadata_->format, kNgramFormat,
+               ngram::Metadata::kFormatMaxLength);
+  LOG(INFO) << "ngram db built with " << num_entries << " entries.";
+  return true;
+}
+
+bool NgramDb::Save() {
+  LOG(INFO) << "saving ngram db: " << file_path();
+  return ShrinkToFit();
+}
+
+}  // namespace rime
@@ -0,0 +1,101 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_NGRAM_DB_H_
+#define RIME_NGRAM_DB_H_
+
+#include <stdint.h>
+#include <limits>
+#include <rime_api.h>
+#include <rime/common.h>
+#include <rime/dict/mapped_file.h>
+
+namespace rime {
+
+namespace ngram {
+
+struct Metadata {
+  static const int kFormatMaxLength = 32;
+  char format[kFormatMaxLength];
+  uint32_t num_entries;
+  // the longest history of an n-gram, in characters.
+  uint32_t max_history_length;
+  // scores are quantized to score_min + q * score_step, with q in [0, 255].
+  float score_min;
+  float score_step;
+  // open addressing hash table of n-gram keys, 0 for empty slots.
+  List<uint64_t> keys;
+  List<uint8_t> scores;
+};
+
+}  // namespace ngram
+
+// A memory-mapped table of log-probabilities of words following histories.
+// An n-gram is keyed by the hash of its history, being the preceding n-1
+// words concatenated, combined with the hash of the word.
+class NgramDb : public MappedFile {
+ public:
+  RIME_DLL explicit NgramDb(const path& file_path);
+
+  RIME_DLL bool Load();
+  bool Lookup(uint64_t key, double* score) const {
+    if (!keys_)
+      return false;
+    for (uint64_t i = key & mask_; keys_[i]; i = (i + 1) & mask_) {
+      if (keys_[i] == key) {
+        *score = metadata_->score_min + scores_[i] * metadata_->score_step;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  RIME_DLL bool Build(const vector<pair<uint64_t, double>>& entries,
+                      uint32_t max_history_length);
+  RIME_DLL bool Save();
+
+  uint32_t max_history_length() const {
+    return metadata_ ? metadata_->max_history_length : 0;
+  }
+  // the highest score representable in the table.
+  double max_score() const {
+    return metadata_ ? metadata_->score_min + 255 * metadata_->score_step
+                     : -std::numeric_limits<double>::infinity();
+  }
+
+  // hashes are saved in the file, so they must not vary across platforms.
+  static uint64_t HashString(const char* str, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= static_cast<uint8_t>(str[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+  static uint64_t HashString(const string& str) {
+    return HashString(str.data(), str.length());
+  }
+  static uint64_t CombineKey(uint64_t history_hash, uint64_t word_hash) {
+    uint64_t key = history_hash * 0x9E3779B97F4A7C15ULL ^ word_hash;
+    // murmur3 finalizer
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key ? key : 1;  // 0 marks empty slots
+  }
+
+ private:
+  ngram::Metadata* metadata_ = nullptr;
+  const uint64_t* keys_ = nullptr;
+  const uint8_t* scores_ = nullptr;
+  uint64_t mask_ = 0;
+};
+
+}  // namespace rime
+
+#endif  // RIME_NGRAM_DB_H_
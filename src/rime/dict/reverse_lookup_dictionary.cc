@@ -13,6 +13,7 @@
 #include <rime/schema.h>
 #include <rime/service.h>
 #include <rime/ticket.h>
+#include <rime/algo/algebra.h>
 #include <rime/dict/db_pool_impl.h>
 #include <rime/dict/dict_settings.h>
 #include <rime/dict/reverse_lookup_dictionary.h>
@@ -27,6 +28,39 @@ const size_t kReverseFormatPrefixLen = sizeof(kReverseFormatPrefix) - 1;
 
 static const char* kStemKeySuffix = "\x1fstem";
 
+vector<size_t> ReverseLookupCommentCache::Find(const vector<string>& texts,
+                                               vector<string>* comments) {
+  vector<size_t> misses;
+  comments->resize(texts.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < texts.size(); ++i) {
+    auto found = comments_.find(texts[i]);
+    if (found != comments_.end()) {
+      (*comments)[i] = found->second;
+    } else {
+      misses.push_back(i);
+    }
+  }
+  return misses;
+}
+
+void ReverseLookupCommentCache::Insert(const vector<string>& texts,
+                                       const vector<string>& comments,
+                                       const vector<size_t>& indices) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (comments_.size() + indices.size() > kCapacity) {
+    comments_.clear();
+  }
+  for (size_t i : indices) {
+    comments_[texts[i]] = comments[i];
+  }
+}
+
+void ReverseLookupCommentCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  comments_.clear();
+}
+
 ReverseDb::ReverseDb(const path& file_path) : MappedFile(file_path) {}
 
 bool ReverseDb::Load() {
@@ -65,6 +99,13 @@ bool ReverseDb::Load() {
   value_trie_.reset(
       new StringTable(metadata_->value_trie.get(), metadata_->value_trie_size));
 
+  // comments of a previous version of the db are no longer valid.
+  std::lock_guard<std::mutex> lock(comment_caches_mutex_);
+  for (const auto& x : comment_caches_) {
+    if (auto cache = x.second.lock()) {
+      cache->Clear();
+    }
+  }
   return true;
 }
 
@@ -202,6 +243,18 @@ uint32_t ReverseDb::dict_file_checksum() const {
   return metadata_ ? metadata_->dict_file_checksum : 0;
 }
 
+an<ReverseLookupCommentCache> ReverseDb::GetCommentCache(
+    const string& formulas) {
+  std::lock_guard<std::mutex> lock(comment_caches_mutex_);
+  auto& cache = comment_caches_[formulas];
+  if (auto existing = cache.lock()) {
+    return existing;
+  }
+  auto created = New<ReverseLookupCommentCache>();
+  cache = created;
+  return created;
+}
+
 ReverseLookupDictionary::ReverseLookupDictionary(an<ReverseDb> db) : db_(db) {}
 
 bool ReverseLookupDictionary::Load() {
@@ -213,6 +266,27 @@ bool ReverseLookupDictionary::ReverseLookup(const string& text,
   return db_->Lookup(text, result);
 }
 
+void ReverseLookupDictionary::LookupComments(const vector<string>& texts,
+                                             Projection* formatter,
+                                             vector<string>* comments) {
+  if (!comment_cache_ || comment_formulas_ != formatter->formulas()) {
+    comment_formulas_ = formatter->formulas();
+    comment_cache_ = db_->GetCommentCache(comment_formulas_);
+  }
+  auto misses = comment_cache_->Find(texts, comments);
+  if (misses.empty())
+    return;
+  for (size_t i : misses) {
+    string& comment = (*comments)[i];
+    if (db_->Lookup(texts[i], &comment)) {
+      formatter->Apply(&comment);
+    } else {
+      comment.clear();
+    }
+  }
+  comment_cache_->Insert(texts, *comments, misses);
+}
+
 bool ReverseLookupDictionary::LookupStems(const string& text, string* result) {
   return db_->Lookup(text + kStemKeySuffix, result);
 }
@@ -9,6 +9,7 @@
 #define RIME_REVERSE_LOOKUP_DICTIONARY_H_
 
 #include <stdint.h>
+#include <mutex>
 #include <rime/common.h>
 #include <rime/component.h>
 #include <rime/dict/db_pool.h>
@@ -36,6 +37,25 @@ struct Metadata {
 
 struct Ticket;
 class DictSettings;
+class Projection;
+
+// Comments formatted from the codes of recently looked up texts, shared by
+// the dictionaries on a reverse db that format comments alike.
+class ReverseLookupCommentCache {
+ public:
+  static constexpr size_t kCapacity = 4096;
+
+  // fills in comments of the texts found; returns indices of the others.
+  vector<size_t> Find(const vector<string>& texts, vector<string>* comments);
+  void Insert(const vector<string>& texts,
+              const vector<string>& comments,
+              const vector<size_t>& indices);
+  void Clear();
+
+ private:
+  std::mutex mutex_;
+  hash_map<string, string> comments_;
+};
 
 class ReverseDb : public MappedFile {
  public:
@@ -54,10 +74,15 @@ class ReverseDb : public MappedFile {
   uint32_t dict_file_checksum() const;
   reverse::Metadata* metadata() const { return metadata_; }
 
+  // gets the comment cache for comments formatted by `formulas`.
+  an<ReverseLookupCommentCache> GetCommentCache(const string& formulas);
+
  private:
   reverse::Metadata* metadata_ = nullptr;
   the<StringTable> key_trie_;
   the<StringTable> value_trie_;
+  std::mutex comment_caches_mutex_;
+  map<string, weak<ReverseLookupCommentCache>> comment_caches_;
 };
 
 class ReverseLookupDictionary
@@ -66,11 +91,18 @@ class ReverseLookupDictionary
   explicit ReverseLookupDictionary(an<ReverseDb> db);
   bool Load();
   bool ReverseLookup(const string& text, string* result);
+  // looks up codes of a batch of texts, formatted as comments by
+  // `formatter`; a comment is left empty if its text is not found.
+  void LookupComments(const vector<string>& texts,
+                      Projection* formatter,
+                      vector<string>* comments);
   bool LookupStems(const string& text, string* result);
   an<DictSettings> GetDictSettings();
 
  protected:
   an<ReverseDb> db_;
+  an<ReverseLookupCommentCache> comment_cache_;
+  string comment_formulas_;
 };
 
 class ResourceResolver;
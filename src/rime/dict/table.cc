@@ -10,6 +10,7 @@
 #include <queue>
 #include <utility>
 #include <rime/common.h>
+#include <rime/algo/strings.h>
 #include <rime/algo/syllabifier.h>
 #include <rime/dict/table.h>
 
@@ -253,6 +254,19 @@ bool Table::OnBuildFinish() {
   string_table_builder_->Dump(image, image_size);
   metadata_->string_table = image;
   metadata_->string_table_size = image_size;
+  size_t num_strings = string_table_builder_->NumKeys();
+  uint8_t* text_flags = Allocate<uint8_t>(num_strings);
+  if (!text_flags) {
+    LOG(ERROR) << "Error creating text flags.";
+    return false;
+  }
+  for (StringId i = 0; i < num_strings; ++i) {
+    if (strings::contains_extended_cjk(string_table_builder_->GetString(i))) {
+      text_flags[i] |= table::kExtendedCjk;
+    }
+  }
+  metadata_->text_flags.size = num_strings;
+  metadata_->text_flags.at = text_flags;
   return true;
 }
 
@@ -633,4 +647,12 @@ string Table::GetEntryText(const table::Entry& entry) {
   return GetString(entry.text);
 }
 
+bool Table::GetEntryTextFlags(const table::Entry& entry,
+                              uint8_t* flags) const {
+  if (!metadata_ || entry.text.str_id() >= metadata_->text_flags.size)
+    return false;
+  *flags = metadata_->text_flags.at[entry.text.str_id()];
+  return true;
+}
+
 }  // namespace rime
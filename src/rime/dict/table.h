@@ -93,12 +93,18 @@ struct Metadata {
   OffsetPtr<Syllabary> syllabary;
   OffsetPtr<Index> index;
   // v2
-  int32_t reserved_1;
-  int32_t reserved_2;
+  // flags of strings in the string table, by string id; empty in tables
+  // built by earlier versions.
+  List<uint8_t> text_flags;
   OffsetPtr<char> string_table;
   uint32_t string_table_size;
 };
 
+// properties of strings, found when the table is built.
+enum TextFlags : uint8_t {
+  kExtendedCjk = 1,
+};
+
 }  // namespace table
 
 class TableAccessor {
@@ -208,6 +214,9 @@ class Table : public MappedFile {
                       size_t start_pos,
                       TableQueryResult* result);
   RIME_DLL string GetEntryText(const table::Entry& entry);
+  // returns false if the table holds no text flags.
+  RIME_DLL bool GetEntryTextFlags(const table::Entry& entry,
+                                  uint8_t* flags) const;
 
   uint32_t dict_file_checksum() const;
   table::Metadata* metadata() const { return metadata_; }
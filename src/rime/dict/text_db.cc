@@ -86,6 +86,7 @@ bool TextDb::Update(const string& key, const string& value) {
   DLOG(INFO) << "update db entry: " << key << " => " << value;
   data_[key] = value;
   modified_ = true;
+  UpdateRevision();
   return true;
 }
 
@@ -96,6 +97,7 @@ bool TextDb::Erase(const string& key) {
   if (data_.erase(key) == 0)
     return false;
   modified_ = true;
+  UpdateRevision();
   return true;
 }
 
@@ -105,6 +107,7 @@ bool TextDb::Open() {
   loaded_ = true;
   readonly_ = false;
   loaded_ = !Exists() || LoadFromFile(file_path());
+  UpdateRevision();
   if (loaded_) {
     string db_name;
     if (!MetaFetch("/db_name", &db_name)) {
@@ -126,6 +129,7 @@ bool TextDb::OpenReadOnly() {
   loaded_ = true;
   readonly_ = false;
   loaded_ = Exists() && LoadFromFile(file_path());
+  UpdateRevision();
   if (loaded_) {
     readonly_ = true;
   } else {
@@ -144,6 +148,7 @@ bool TextDb::Close() {
   loaded_ = false;
   readonly_ = false;
   Clear();
+  UpdateRevision();
   modified_ = false;
   return true;
 }
@@ -174,6 +179,7 @@ bool TextDb::Restore(const path& snapshot_file) {
     return false;
   }
   modified_ = false;
+  UpdateRevision();
   return true;
 }
 
@@ -197,6 +203,7 @@ bool TextDb::MetaUpdate(const string& key, const string& value) {
   DLOG(INFO) << "update db metadata: " << key << " => " << value;
   metadata_[key] = value;
   modified_ = true;
+  UpdateRevision();
   return true;
 }
 
@@ -118,7 +118,11 @@ void UserDictEntryIterator::AddFilter(DictEntryFilter filter) {
   DictEntryFilterBinder::AddFilter(filter);
   // the introduced filter could invalidate the current or even all the
   // remaining entries
-  while (!exhausted() && !filter_(Peek())) {
+  SkipFilteredEntries();
+}
+
+void UserDictEntryIterator::SkipFilteredEntries() {
+  while (filter_ && !exhausted() && !filter_(Peek())) {
     FindNextEntry();
   }
 }
@@ -509,6 +513,11 @@ bool UserDictionary::CommitPendingTransaction() {
   return false;
 }
 
+bool UserDictionary::HasPendingTransaction() const {
+  auto db = As<Transactional>(db_);
+  return db && db->in_transaction();
+}
+
 bool UserDictionary::TranslateCodeToString(const Code& code, string* result) {
   if (!table_ || !result)
     return false;
@@ -547,7 +556,7 @@ an<DictEntry> UserDictionary::CreateDictEntry(const string& key,
   if (v.tick < present_tick)
     v.dee = algo::formula_d(0, (double)present_tick, v.dee, (double)v.tick);
   // create!
-  e = New<DictEntry>();
+  e = NewPooled<DictEntry>();
   e->text = key.substr(separator_pos + 1);
   e->commit_count = v.commits;
   // TODO: argument s not defined...
@@ -572,8 +581,11 @@ UserDictionaryComponent::UserDictionaryComponent() {}
 
 UserDictionary* UserDictionaryComponent::Create(const string& dict_name,
                                                 const string& db_class) {
+  auto& retention = Service::instance().retention();
   auto db = db_pool_[dict_name].lock();
-  if (!db) {
+  if (db) {
+    retention.RecordLookup(db->file_path(), db.use_count());
+  } else {
     auto component = Db::Require(db_class);
     if (!component) {
       LOG(ERROR) << "undefined db class '" << db_class << "'.";
@@ -581,7 +593,9 @@ UserDictionary* UserDictionaryComponent::Create(const string& dict_name,
     }
     db.reset(component->Create(dict_name));
     db_pool_[dict_name] = db;
+    retention.RecordLookup(db->file_path(), 0);
   }
+  retention.Retain(db, db->file_path());
   return new UserDictionary(dict_name, db);
 }
 
@@ -24,6 +24,8 @@ class UserDictEntryIterator : public DictEntryFilterBinder {
   void SortRange(size_t start, size_t count);
 
   void AddFilter(DictEntryFilter filter) override;
+  // skips entries rejected by the filters, as those added after the filters.
+  void SkipFilteredEntries();
   an<DictEntry> Peek();
   bool Next();
   bool exhausted() const { return index_ >= cache_.size(); }
@@ -75,9 +77,13 @@ class UserDictionary : public Class<UserDictionary, const Ticket&> {
   bool NewTransaction();
   bool RevertRecentTransaction();
   bool CommitPendingTransaction();
+  bool HasPendingTransaction() const;
 
   const string& name() const { return name_; }
   TickCount tick() const { return tick_; }
+  // changes whenever lookup results may have changed, through any user
+  // dictionary sharing the db.
+  size_t revision() const { return db_ ? db_->revision() : 0; }
 
   static an<DictEntry> CreateDictEntry(const string& key,
                                        const string& value,
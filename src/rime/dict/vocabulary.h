@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <rime_api.h>
+#include <rime/block_pool.h>
 #include <rime/common.h>
 
 namespace rime {
@@ -5,6 +5,7 @@
 // 2011-04-24 GONG Chen <chen.sst@gmail.com>
 //
 #include <cctype>
+#include <exception>
 #include <rime/common.h>
 #include <rime/composition.h>
 #include <rime/context.h>
@@ -17,8 +18,10 @@
 #include <rime/schema.h>
 #include <rime/segmentation.h>
 #include <rime/segmentor.h>
+#include <rime/service.h>
 #include <rime/switcher.h>
 #include <rime/switches.h>
+#include <rime/thread_pool.h>
 #include <rime/ticket.h>
 #include <rime/translation.h>
 #include <rime/translator.h>
@@ -39,6 +42,8 @@ class ConcreteEngine : public Engine {
   void InitializeOptions();
   void CalculateSegmentation(Segmentation* segments);
   void TranslateSegments(Segmentation* segments);
+  vector<an<Translation>> QueryTranslators(const string& input,
+                                           const Segment& segment);
   void FormatText(string* text);
   void OnCommit(Context* ctx);
   void OnSelect(Context* ctx);
@@ -53,6 +58,7 @@ class ConcreteEngine : public Engine {
   vector<of<Formatter>> formatters_;
   vector<of<Processor>> post_processors_;
   an<Switcher> switcher_;
+  bool parallel_translation_ = false;
 };
 
 // implementations
@@ -211,12 +217,14 @@ void ConcreteEngine::TranslateSegments(Segmentation* segments) {
     string input = segments->input().substr(segment.start, len);
     DLOG(INFO) << "translating segment: [" << input << "]";
     auto menu = New<Menu>();
-    for (auto& translator : translators_) {
-      auto translation = translator->Query(input, segment);
+    auto translations = QueryTranslators(input, segment);
+    for (size_t i = 0; i < translators_.size(); ++i) {
+      auto& translation = translations[i];
       if (!translation)
         continue;
       if (translation->exhausted()) {
-        DLOG(INFO) << translator->name_space() << " made a futile translation.";
+        DLOG(INFO) << translators_[i]->name_space()
+                   << " made a futile translation.";
         continue;
       }
       menu->AddTranslation(translation);
@@ -232,6 +240,53 @@ void ConcreteEngine::TranslateSegments(Segmentation* segments) {
   }
 }
 
+// returns the translations in the order of translators.
+// with parallel translation, translators that do not support concurrent
+// queries are queried first; then the rest run on the thread pool, with the
+// last of them on the engine's thread.
+vector<an<Translation>> ConcreteEngine::QueryTranslators(
+    const string& input,
+    const Segment& segment) {
+  size_t n = translators_.size();
+  vector<an<Translation>> translations(n);
+  vector<size_t> concurrent;
+  for (size_t i = 0; i < n; ++i) {
+    if (parallel_translation_ && translators_[i]->concurrent_query()) {
+      concurrent.push_back(i);
+    } else {
+      translations[i] = translators_[i]->Query(input, segment);
+    }
+  }
+  if (concurrent.empty())
+    return translations;
+  size_t last = concurrent.back();
+  concurrent.pop_back();
+  ThreadPool* pool =
+      concurrent.empty() ? nullptr : Service::instance().translation_pool();
+  vector<std::future<an<Translation>>> results;
+  for (size_t i : concurrent) {
+    Translator* translator = translators_[i].get();
+    results.push_back(pool->Post(
+        [=, &input, &segment] { return translator->Query(input, segment); }));
+  }
+  std::exception_ptr error;
+  try {
+    translations[last] = translators_[last]->Query(input, segment);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the tasks refer to input and segment; wait for all before leaving.
+  for (auto& result : results) {
+    result.wait();
+  }
+  if (error)
+    std::rethrow_exception(error);
+  for (size_t k = 0; k < concurrent.size(); ++k) {
+    translations[concurrent[k]] = results[k].get();
+  }
+  return translations;
+}
+
 void ConcreteEngine::FormatText(string* text) {
   if (formatters_.empty())
     return;
@@ -293,13 +348,133 @@ void ConcreteEngine::ApplySchema(Schema* schema) {
   message_sink_("schema", schema_->schema_id() + "/" + schema_->schema_name());
 }
 
+// reads the tags that a component in the given name space is limited to.
+static vector<string> GetComponentTags(Config* config,
+                                       const string& name_space,
+                                       bool include_tag) {
+  vector<string> tags;
+  string tag;
+  if (include_tag && config->GetString(name_space + "/tag", &tag)) {
+    tags.push_back(tag);
+  }
+  if (auto list = config->GetList(name_space + "/tags")) {
+    for (size_t i = 0; i < list->size(); ++i) {
+      if (auto value = list->GetValueAt(i)) {
+        tags.push_back(value->str());
+      }
+    }
+  }
+  return tags;
+}
+
+// defers creating the translator until a segment is first translated by it.
+// if the translator is configured with tags, that would be the first segment
+// carrying any of the tags.
+class LazyTranslator : public Translator {
+ public:
+  LazyTranslator(const Ticket& ticket, Translator::Component* component)
+      : Translator(ticket),
+        ticket_(ticket),
+        component_(component),
+        tags_(GetComponentTags(ticket.schema->config(), ticket.name_space,
+                               true)) {}
+
+  // the translator is created in the first query, on the engine's thread.
+  bool concurrent_query() const override {
+    return translator_ && translator_->concurrent_query();
+  }
+
+  an<Translation> Query(const string& input, const Segment& segment) override {
+    if (!translator_) {
+      if (!component_ || (!tags_.empty() && !segment.HasAnyTagIn(tags_)))
+        return nullptr;
+      LOG(INFO) << "creating translator on first use: " << ticket_.klass;
+      translator_.reset(component_->Create(ticket_));
+      component_ = nullptr;
+      if (!translator_) {
+        LOG(ERROR) << "error creating translator from ticket: '"
+                   << ticket_.klass << "'";
+        return nullptr;
+      }
+    }
+    return translator_->Query(input, segment);
+  }
+
+ private:
+  Ticket ticket_;
+  Translator::Component* component_;
+  vector<string> tags_;
+  the<Translator> translator_;
+};
+
+// defers creating the filter until it applies to a segment for the first time.
+class LazyFilter : public Filter {
+ public:
+  LazyFilter(const Ticket& ticket, Filter::Component* component)
+      : Filter(ticket),
+        ticket_(ticket),
+        component_(component),
+        tags_(GetComponentTags(ticket.schema->config(), ticket.name_space,
+                               false)) {}
+
+  an<Translation> Apply(an<Translation> translation,
+                        CandidateList* candidates) override {
+    return filter_ ? filter_->Apply(translation, candidates) : translation;
+  }
+
+  bool AppliesToSegment(Segment* segment) override {
+    if (!filter_) {
+      if (!component_ || (!tags_.empty() && !segment->HasAnyTagIn(tags_)))
+        return false;
+      LOG(INFO) << "creating filter on first use: " << ticket_.klass;
+      filter_.reset(component_->Create(ticket_));
+      component_ = nullptr;
+      if (!filter_) {
+        LOG(ERROR) << "error creating filter from ticket: '" << ticket_.klass
+                   << "'";
+        return false;
+      }
+    }
+    return filter_->AppliesToSegment(segment);
+  }
+
+ private:
+  Ticket ticket_;
+  Filter::Component* component_;
+  vector<string> tags_;
+  the<Filter> filter_;
+};
+
+template <typename T>
+inline T* CreateComponent(typename T::Component* component,
+                          const Ticket& ticket,
+                          bool lazy) {
+  return component->Create(ticket);
+}
+
+template <>
+inline Translator* CreateComponent<Translator>(Translator::Component* component,
+                                               const Ticket& ticket,
+                                               bool lazy) {
+  return lazy ? new LazyTranslator(ticket, component)
+              : component->Create(ticket);
+}
+
+template <>
+inline Filter* CreateComponent<Filter>(Filter::Component* component,
+                                       const Ticket& ticket,
+                                       bool lazy) {
+  return lazy ? new LazyFilter(ticket, component) : component->Create(ticket);
+}
+
 // Helper template function to create components
 template <typename T>
 inline void CreateComponentsFromList(Engine* engine,
                                      Config* config,
                                      const string& config_key,
                                      const string& component_type,
-                                     vector<an<T>>& target_collection) {
+                                     vector<an<T>>& target_collection,
+                                     bool lazy = false) {
   if (auto component_list = config->GetList(config_key)) {
     size_t n = component_list->size();
     for (size_t i = 0; i < n; ++i) {
@@ -313,7 +488,7 @@ inline void CreateComponentsFromList(Engine* engine,
                    << ticket.klass << "'";
         continue;
       }
-      auto component = c->Create(ticket);
+      auto component = CreateComponent<T>(c, ticket, lazy);
       if (!component) {
         LOG(ERROR) << "error creating " << component_type << " from ticket: '"
                    << ticket.klass << "'";
@@ -346,15 +521,26 @@ void ConcreteEngine::InitializeComponents() {
   if (!config)
     return;
 
+  // translators and filters can be created on first use, which saves loading
+  // dictionaries and other resources that might never be used in a session.
+  bool lazy_loading = false;
+  config->GetBool("engine/lazy_loading", &lazy_loading);
+
+  // translators that support concurrent queries can run on a thread pool,
+  // see Translator::concurrent_query().
+  parallel_translation_ = false;
+  config->GetBool("engine/parallel_translation", &parallel_translation_);
+
   // Create components using inline template function
   CreateComponentsFromList<Processor>(this, config, "engine/processors",
                                       "processor", processors_);
   CreateComponentsFromList<Segmentor>(this, config, "engine/segmentors",
                                       "segmentor", segmentors_);
   CreateComponentsFromList<Translator>(this, config, "engine/translators",
-                                       "translator", translators_);
+                                       "translator", translators_,
+                                       lazy_loading);
   CreateComponentsFromList<Filter>(this, config, "engine/filters", "filter",
-                                   filters_);
+                                   filters_, lazy_loading);
   // create formatters
   auto c_formatter = Formatter::Require("shape_formatter");
   if (c_formatter) {
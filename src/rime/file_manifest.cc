@@ -0,0 +1,196 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <boost/crc.hpp>
+#include <rime/file_manifest.h>
+
+namespace fs = std::filesystem;
+
+namespace rime {
+
+static const char kManifestHeader[] = "# Rime file manifest";
+
+static string ManifestKey(const path& file_path) {
+  return file_path.lexically_normal().u8string();
+}
+
+// a file modified within the resolution of its timestamp could be modified
+// again without changing the stamp; hash it again next time.
+static bool IsSettled(const FileManifest::Stamp& stamp) {
+  auto now = fs::file_time_type::clock::now().time_since_epoch();
+  auto settled = now - std::chrono::seconds(2);
+  return stamp.mtime < static_cast<int64_t>(settled.count());
+}
+
+bool FileManifest::Load(const path& manifest_path) {
+  std::ifstream fin(manifest_path.c_str());
+  string line;
+  if (!fin || !std::getline(fin, line) || line != kManifestHeader) {
+    return false;
+  }
+  map<string, Stamp> stamps;
+  while (std::getline(fin, line)) {
+    std::istringstream iss(line);
+    Stamp stamp;
+    string file_path;
+    if (!(iss >> stamp.size >> stamp.mtime >> stamp.crc) ||
+        iss.get() != '\t' || !std::getline(iss, file_path) ||
+        file_path.empty()) {
+      LOG(WARNING) << "invalid record in file manifest: " << line;
+      continue;
+    }
+    stamps[file_path] = stamp;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  stamps_.swap(stamps);
+  modified_ = false;
+  return true;
+}
+
+bool FileManifest::Save(const path& manifest_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream fout(manifest_path.c_str());
+  if (!fout) {
+    LOG(ERROR) << "error saving file manifest: " << manifest_path;
+    return false;
+  }
+  fout << kManifestHeader << '\n';
+  for (const auto& entry : stamps_) {
+    const Stamp& stamp = entry.second;
+    fout << stamp.size << '\t' << stamp.mtime << '\t' << stamp.crc << '\t'
+         << entry.first << '\n';
+  }
+  fout.close();
+  if (!fout) {
+    return false;
+  }
+  modified_ = false;
+  return true;
+}
+
+bool FileManifest::GetStamp(const path& file_path, Stamp* stamp) {
+  Stamp current;
+  if (!ReadStamp(file_path, &current)) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (FindUpToDate(file_path, current, stamp)) {
+      return true;
+    }
+  }
+  DLOG(INFO) << "hashing modified file: " << file_path;
+  current.crc = HashFile(file_path);
+  *stamp = current;
+  if (IsSettled(current)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stamps_[ManifestKey(file_path)] = current;
+    modified_ = true;
+  }
+  return true;
+}
+
+void FileManifest::Prefetch(const vector<path>& files) {
+#ifndef RIME_NO_THREADING
+  vector<pair<path, Stamp>> modified_files;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& file_path : files) {
+      Stamp current;
+      Stamp recorded;
+      if (ReadStamp(file_path, &current) &&
+          !FindUpToDate(file_path, current, &recorded)) {
+        modified_files.emplace_back(file_path, current);
+      }
+    }
+  }
+  // a single file is hashed just as well on demand.
+  if (modified_files.size() < 2) {
+    return;
+  }
+  vector<std::future<uint32_t>> hashes;
+  for (const auto& file : modified_files) {
+    hashes.push_back(std::async(std::launch::async, &FileManifest::HashFile,
+                                file.first));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < modified_files.size(); ++i) {
+    Stamp& stamp = modified_files[i].second;
+    stamp.crc = hashes[i].get();
+    if (IsSettled(stamp)) {
+      stamps_[ManifestKey(modified_files[i].first)] = stamp;
+      modified_ = true;
+    }
+  }
+#endif  // RIME_NO_THREADING
+}
+
+void FileManifest::ProcessFile(const path& file_path,
+                               ChecksumComputer* checksum) {
+  Stamp stamp;
+  if (GetStamp(file_path, &stamp)) {
+    checksum->ProcessContent(stamp.crc, stamp.size);
+  } else {
+    checksum->ProcessFile(file_path);
+  }
+}
+
+uint32_t FileManifest::Checksum(const path& file_path) {
+  ChecksumComputer c;
+  ProcessFile(file_path, &c);
+  return c.Checksum();
+}
+
+bool FileManifest::modified() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return modified_;
+}
+
+bool FileManifest::ReadStamp(const path& file_path, Stamp* stamp) {
+  std::error_code ec;
+  auto size = fs::file_size(file_path, ec);
+  if (ec)
+    return false;
+  auto mtime = fs::last_write_time(file_path, ec);
+  if (ec)
+    return false;
+  stamp->size = size;
+  stamp->mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  return true;
+}
+
+uint32_t FileManifest::HashFile(const path& file_path) {
+  boost::crc_32_type crc(0);
+  std::ifstream fin(file_path.c_str(), std::ios::binary);
+  std::array<char, 64 * 1024> buffer;
+  while (fin) {
+    fin.read(buffer.data(), buffer.size());
+    std::streamsize bytes_read = fin.gcount();
+    if (bytes_read > 0) {
+      crc.process_bytes(buffer.data(), bytes_read);
+    }
+  }
+  return crc.get_interim_remainder();
+}
+
+bool FileManifest::FindUpToDate(const path& file_path,
+                                const Stamp& current,
+                                Stamp* stamp) {
+  auto found = stamps_.find(ManifestKey(file_path));
+  if (found == stamps_.end() || found->second.size != current.size ||
+      found->second.mtime != current.mtime) {
+    return false;
+  }
+  *stamp = found->second;
+  return true;
+}
+
+}  // namespace rime
@@ -0,0 +1,56 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_FILE_MANIFEST_H_
+#define RIME_FILE_MANIFEST_H_
+
+#include <stdint.h>
+#include <mutex>
+#include <rime_api.h>
+#include <rime/common.h>
+#include <rime/algo/utilities.h>
+
+namespace rime {
+
+// Records size, modification time and content hash of source files read by
+// deployment tasks, persisted in the staging directory, so that unchanged
+// files need not be hashed again at the next maintenance run.
+class RIME_DLL FileManifest {
+ public:
+  struct Stamp {
+    uintmax_t size = 0;
+    int64_t mtime = 0;
+    // interim CRC-32 remainder after processing the file from remainder 0.
+    uint32_t crc = 0;
+  };
+
+  bool Load(const path& manifest_path);
+  bool Save(const path& manifest_path);
+
+  // gets the stamp of a file, hashing its content only if the file has been
+  // modified since it was last recorded.
+  bool GetStamp(const path& file_path, Stamp* stamp);
+  // hashes modified files among `files` in parallel.
+  void Prefetch(const vector<path>& files);
+  // adds the content of a file to `checksum`, reusing the recorded hash if
+  // the file has not been modified since.
+  void ProcessFile(const path& file_path, ChecksumComputer* checksum);
+  uint32_t Checksum(const path& file_path);
+
+  bool modified() const;
+
+ private:
+  static bool ReadStamp(const path& file_path, Stamp* stamp);
+  static uint32_t HashFile(const path& file_path);
+  bool FindUpToDate(const path& file_path, const Stamp& current, Stamp* stamp);
+
+  mutable std::mutex mutex_;
+  map<string, Stamp> stamps_;
+  bool modified_ = false;
+};
+
+}  // namespace rime
+
+#endif  // RIME_FILE_MANIFEST_H_
@@ -0,0 +1,100 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <rime/gear/cached_grammar.h>
+
+namespace rime {
+
+CachedGrammar::CachedGrammar(Grammar* grammar, size_t capacity)
+    : grammar_(grammar), capacity_(capacity) {}
+
+CachedGrammar::~CachedGrammar() {
+  size_t total = stats_.hits + stats_.misses;
+  if (total > 0) {
+    LOG(INFO) << "grammar cache: " << stats_.hits << " hits, "
+              << stats_.misses << " misses (" << stats_.hits * 100 / total
+              << "% hit rate), " << stats_.resets << " resets.";
+  }
+}
+
+double CachedGrammar::Query(const string& context,
+                            const string& word,
+                            bool is_rear) {
+  ResetIfFull(1);
+  uint64_t key = MakeKey(Intern(context), word, is_rear);
+  auto found = scores_.find(key);
+  if (found != scores_.end()) {
+    ++stats_.hits;
+    return found->second;
+  }
+  ++stats_.misses;
+  double score = grammar_->Query(context, word, is_rear);
+  scores_.emplace(key, score);
+  return score;
+}
+
+void CachedGrammar::QueryBatch(const string& context,
+                               const string* const words[],
+                               size_t num_words,
+                               bool is_rear,
+                               double scores[]) {
+  ResetIfFull(num_words);
+  uint32_t context_id = Intern(context);
+  missing_words_.clear();
+  missing_keys_.clear();
+  missing_indices_.clear();
+  for (size_t i = 0; i < num_words; ++i) {
+    uint64_t key = MakeKey(context_id, *words[i], is_rear);
+    auto found = scores_.find(key);
+    if (found != scores_.end()) {
+      scores[i] = found->second;
+    } else {
+      missing_words_.push_back(words[i]);
+      missing_keys_.push_back(key);
+      missing_indices_.push_back(i);
+    }
+  }
+  size_t num_missing = missing_words_.size();
+  stats_.hits += num_words - num_missing;
+  stats_.misses += num_missing;
+  if (num_missing == 0)
+    return;
+  missing_scores_.resize(num_missing);
+  grammar_->QueryBatch(context, missing_words_.data(), num_missing, is_rear,
+                       missing_scores_.data());
+  for (size_t j = 0; j < num_missing; ++j) {
+    scores[missing_indices_[j]] = missing_scores_[j];
+    scores_.emplace(missing_keys_[j], missing_scores_[j]);
+  }
+}
+
+uint32_t CachedGrammar::Intern(const string& text) {
+  auto found = ids_.find(text);
+  if (found != ids_.end())
+    return found->second;
+  uint32_t id = static_cast<uint32_t>(ids_.size());
+  ids_.emplace(text, id);
+  return id;
+}
+
+uint64_t CachedGrammar::MakeKey(uint32_t context_id,
+                                const string& word,
+                                bool is_rear) {
+  // interned strings are fewer than twice the capacity, so ids fit in 31 bits.
+  return (uint64_t(context_id) << 32) | (uint64_t(Intern(word)) << 1) |
+         (is_rear ? 1 : 0);
+}
+
+void CachedGrammar::ResetIfFull(size_t num_insertions) {
+  // each insertion interns a word, and the context once for a batch.
+  if (scores_.size() + num_insertions <= capacity_ &&
+      ids_.size() + num_insertions + 1 <= 2 * capacity_)
+    return;
+  scores_.clear();
+  ids_.clear();
+  ++stats_.resets;
+}
+
+}  // namespace rime
@@ -0,0 +1,65 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_CACHED_GRAMMAR_H_
+#define RIME_CACHED_GRAMMAR_H_
+
+#include <stdint.h>
+#include <rime/common.h>
+#include <rime/gear/grammar.h>
+
+namespace rime {
+
+// Remembers scores given by a grammar, so that the words of the sentence
+// being typed are not scored again on every keystroke.
+// Owned by the Poet of a translator, it lives as long as the session's
+// schema; the cache is dropped as a whole once it holds `capacity` scores.
+class CachedGrammar : public Grammar {
+ public:
+  static constexpr size_t kDefaultCapacity = 1 << 16;
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t resets = 0;
+  };
+
+  explicit CachedGrammar(Grammar* grammar,
+                         size_t capacity = kDefaultCapacity);
+  ~CachedGrammar() override;
+
+  double Query(const string& context, const string& word, bool is_rear) override;
+  void QueryBatch(const string& context,
+                  const string* const words[],
+                  size_t num_words,
+                  bool is_rear,
+                  double scores[]) override;
+  double MaxScore(bool is_rear) const override {
+    return grammar_->MaxScore(is_rear);
+  }
+
+  const Stats& stats() const { return stats_; }
+  size_t size() const { return scores_.size(); }
+
+ private:
+  uint32_t Intern(const string& text);
+  uint64_t MakeKey(uint32_t context_id, const string& word, bool is_rear);
+  void ResetIfFull(size_t num_insertions);
+
+  the<Grammar> grammar_;
+  size_t capacity_;
+  hash_map<string, uint32_t> ids_;
+  hash_map<uint64_t, double> scores_;
+  Stats stats_;
+  // buffers for scores missing in a batch.
+  vector<const string*> missing_words_;
+  vector<uint64_t> missing_keys_;
+  vector<size_t> missing_indices_;
+  vector<double> missing_scores_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_CACHED_GRAMMAR_H_
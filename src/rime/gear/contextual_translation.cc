@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <iterator>
 #include <rime/gear/contextual_translation.h>
 #include <rime/gear/grammar.h>
 #include <rime/gear/translator_commons.h>
@@ -7,58 +6,126 @@
 namespace rime {
 
 const int kContextualSearchLimit = 32;
+// phrases pulled and scored together while the best of a group can be cached
+// before the group ends.
+const int kContextualBatchSize = 8;
 
+static bool is_contextual(const an<Candidate>& cand) {
+  return cand->type() == "phrase" || cand->type() == "user_phrase" ||
+         cand->type() == "table" || cand->type() == "user_table" ||
+         cand->type() == "completion";
+}
+
+static bool compare_by_weight(const an<Phrase>& a, const an<Phrase>& b) {
+  return a->weight() < b->weight();
+}
+
+// whether phrases of the type come in descending order of weight.
+// completions are ordered by the length of the code to complete first, and
+// predictive user phrases by code.
+static bool is_ordered_by_weight(const string& type) {
+  return type != "completion" && type != "user_table";
+}
+
+// Phrases are scored in groups, ending at the same position and of the same
+// type, and cached in the order of scored weights. Where a group comes in
+// descending order of weight from the inner translation, the best scored
+// phrase is cached once no phrase to come can overtake it, even with the best
+// possible score by the grammar; other groups are pulled as a whole. Either
+// way, phrases exceeding the search limit are cached in the order of scored
+// weights among those pulled.
 bool ContextualTranslation::Replenish() {
-  vector<of<Phrase>> queue;
-  size_t end_pos = 0;
-  std::string last_type;
-  while (!translation_->exhausted() &&
-         cache_.size() + queue.size() < kContextualSearchLimit) {
-    auto cand = translation_->Peek();
-    DLOG(INFO) << cand->text() << " cache/queue: " << cache_.size() << "/"
-               << queue.size();
-    if (cand->type() == "phrase" || cand->type() == "user_phrase" ||
-        cand->type() == "table" || cand->type() == "user_table" ||
-        cand->type() == "completion") {
-      if (end_pos != cand->end() || last_type != cand->type()) {
-        end_pos = cand->end();
-        last_type = cand->type();
-        AppendToCache(queue);
+  while (cache_.empty()) {
+    auto cand = translation_->exhausted() ? nullptr : translation_->Peek();
+    auto phrase = cand && is_contextual(cand) ? As<Phrase>(cand) : nullptr;
+    if (!queue_.empty()) {
+      if (!phrase || end_pos_ != phrase->end() ||
+          last_type_ != phrase->type()) {
+        AppendToCache();
+        break;
+      }
+      if (queue_.size() >= kContextualSearchLimit) {
+        CacheBestPhrase();
+        break;
       }
-      queue.push_back(Evaluate(As<Phrase>(cand)));
-    } else {
-      AppendToCache(queue);
+      if (is_ordered_by_weight(last_type_)) {
+        bool is_rear = phrase->end() == input_.length();
+        double bound =
+            phrase->weight() +
+            (grammar_ ? grammar_->MaxScore(is_rear) : Grammar::kPenalty);
+        if (queue_.front()->weight() >= bound) {
+          CacheBestPhrase();
+          break;
+        }
+      }
+    } else if (!cand) {
+      break;
+    } else if (!phrase) {
       cache_.push_back(cand);
-    }
-    if (!translation_->Next()) {
+      translation_->Next();
       break;
     }
+    Pull(phrase);
   }
-  AppendToCache(queue);
   return !cache_.empty();
 }
 
-an<Phrase> ContextualTranslation::Evaluate(an<Phrase> phrase) {
-  bool is_rear = phrase->end() == input_.length();
-  double weight = Grammar::Evaluate(preceding_text_, phrase->text(),
-                                    phrase->weight(), is_rear, grammar_);
-  phrase->set_weight(weight);
-  DLOG(INFO) << "contextual suggestion: " << phrase->text()
-             << " weight: " << phrase->weight();
-  return phrase;
+// pulls `phrase` and the following phrases of its group, then scores them in
+// a batch.
+void ContextualTranslation::Pull(an<Phrase> phrase) {
+  end_pos_ = phrase->end();
+  last_type_ = phrase->type();
+  size_t max_phrases = kContextualSearchLimit - queue_.size();
+  if (is_ordered_by_weight(last_type_)) {
+    max_phrases = (std::min)(max_phrases, size_t(kContextualBatchSize));
+  }
+  size_t first = queue_.size();
+  while (phrase) {
+    queue_.push_back(phrase);
+    translation_->Next();
+    if (queue_.size() - first >= max_phrases || translation_->exhausted())
+      break;
+    auto cand = translation_->Peek();
+    phrase = is_contextual(cand) ? As<Phrase>(cand) : nullptr;
+    if (phrase && (phrase->end() != end_pos_ || phrase->type() != last_type_))
+      phrase = nullptr;
+  }
+  Evaluate(first);
+}
+
+void ContextualTranslation::Evaluate(size_t first) {
+  // phrases of a group end at the same position.
+  bool is_rear = end_pos_ == input_.length();
+  vector<const string*> words;
+  words.reserve(queue_.size() - first);
+  for (size_t i = first; i < queue_.size(); ++i) {
+    words.push_back(&queue_[i]->text());
+  }
+  vector<double> scores(words.size());
+  Grammar::EvaluateBatch(preceding_text_, words.data(), words.size(), is_rear,
+                         grammar_, scores.data());
+  for (size_t i = first; i < queue_.size(); ++i) {
+    auto& phrase = queue_[i];
+    phrase->set_weight(phrase->weight() + scores[i - first]);
+    DLOG(INFO) << "contextual suggestion: " << phrase->text()
+               << " weight: " << phrase->weight();
+    std::push_heap(queue_.begin(), queue_.begin() + i + 1, compare_by_weight);
+  }
 }
 
-static bool compare_by_weight_desc(const an<Phrase>& a, const an<Phrase>& b) {
-  return a->weight() > b->weight();
+void ContextualTranslation::CacheBestPhrase() {
+  std::pop_heap(queue_.begin(), queue_.end(), compare_by_weight);
+  cache_.push_back(queue_.back());
+  queue_.pop_back();
 }
 
-void ContextualTranslation::AppendToCache(vector<of<Phrase>>& queue) {
-  if (queue.empty())
+void ContextualTranslation::AppendToCache() {
+  if (queue_.empty())
     return;
-  DLOG(INFO) << "appending to cache " << queue.size() << " candidates.";
-  std::sort(queue.begin(), queue.end(), compare_by_weight_desc);
-  std::copy(queue.begin(), queue.end(), std::back_inserter(cache_));
-  queue.clear();
+  DLOG(INFO) << "appending to cache " << queue_.size() << " candidates.";
+  while (!queue_.empty()) {
+    CacheBestPhrase();
+  }
 }
 
 }  // namespace rime
@@ -27,12 +27,19 @@ class ContextualTranslation : public PrefetchTranslation {
   bool Replenish() override;
 
  private:
-  an<Phrase> Evaluate(an<Phrase> phrase);
-  void AppendToCache(vector<of<Phrase>>& queue);
+  void Pull(an<Phrase> phrase);
+  void Evaluate(size_t first);
+  void CacheBestPhrase();
+  void AppendToCache();
 
   string input_;
   string preceding_text_;
   Grammar* grammar_;
+  // phrases ending at the same position and of the same type, yet to be
+  // cached; a heap ordered by scored weight.
+  vector<of<Phrase>> queue_;
+  size_t end_pos_ = 0;
+  string last_type_;
 };
 
 }  // namespace rime
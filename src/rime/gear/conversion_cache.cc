@@ -0,0 +1,40 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <rime/gear/conversion_cache.h>
+
+namespace rime {
+
+ConversionCache::ConversionCache(size_t capacity) : capacity_(capacity) {}
+
+bool ConversionCache::Find(const string& text, an<const Forms>* forms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(text);
+  if (found == index_.end())
+    return false;
+  recent_.splice(recent_.begin(), recent_, found->second);
+  *forms = found->second->second;
+  return true;
+}
+
+void ConversionCache::Insert(const string& text, an<const Forms> forms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // another session may have converted the same text meanwhile.
+  if (index_.find(text) != index_.end())
+    return;
+  recent_.emplace_front(text, std::move(forms));
+  index_[text] = recent_.begin();
+  if (recent_.size() > capacity_) {
+    index_.erase(recent_.back().first);
+    recent_.pop_back();
+  }
+}
+
+size_t ConversionCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return recent_.size();
+}
+
+}  // namespace rime
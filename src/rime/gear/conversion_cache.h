@@ -0,0 +1,44 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_CONVERSION_CACHE_H_
+#define RIME_CONVERSION_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <utility>
+#include <rime/common.h>
+
+namespace rime {
+
+// Recent conversions of texts into their converted forms, shared by the
+// simplifiers using the same OpenCC config across sessions.
+// Once it holds `capacity` texts, the least recently used one is dropped.
+class ConversionCache {
+ public:
+  using Forms = vector<string>;
+
+  explicit ConversionCache(size_t capacity);
+
+  // finds the forms of `text` converted earlier, nullptr if it was left
+  // unchanged; returns false if the text is not in the cache.
+  bool Find(const string& text, an<const Forms>* forms);
+  void Insert(const string& text, an<const Forms> forms);
+
+  size_t size() const;
+  size_t capacity() const { return capacity_; }
+
+ private:
+  using Entries = std::list<pair<string, an<const Forms>>>;
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  Entries recent_;  // most recently used first
+  hash_map<string, Entries::iterator> index_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_CONVERSION_CACHE_H_
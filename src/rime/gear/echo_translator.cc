@@ -35,7 +35,7 @@ an<Translation> EchoTranslator::Query(const string& input,
     return nullptr;
   }
   auto candidate =
-      New<SimpleCandidate>("raw", segment.start, segment.end, input);
+      NewPooled<SimpleCandidate>("raw", segment.start, segment.end, input);
   if (candidate) {
     candidate->set_quality(-100);  // lowest priority
   }
@@ -1,6 +1,8 @@
 #ifndef RIME_GRAMMAR_H_
 #define RIME_GRAMMAR_H_
 
+#include <algorithm>
+#include <limits>
 #include <rime/common.h>
 #include <rime/component.h>
 
@@ -10,21 +12,51 @@ class Config;
 
 class Grammar : public Class<Grammar, Config*> {
  public:
+  // log(1e-6) ≈ -13.81
+  static constexpr double kPenalty = -13.815510557964274;
+
   virtual ~Grammar() {}
   virtual double Query(const string& context,
                        const string& word,
                        bool is_rear) = 0;
+  // scores `num_words` words following the same context, in order.
+  // override it to look up the context only once for all words.
+  virtual void QueryBatch(const string& context,
+                          const string* const words[],
+                          size_t num_words,
+                          bool is_rear,
+                          double scores[]) {
+    for (size_t i = 0; i < num_words; ++i) {
+      scores[i] = Query(context, *words[i], is_rear);
+    }
+  }
+  // an upper bound of the scores returned by Query; none by default.
+  virtual double MaxScore(bool is_rear) const {
+    return std::numeric_limits<double>::infinity();
+  }
 
   inline static double Evaluate(const string& context,
                                 const string& entry_text,
                                 double entry_weight,
                                 bool is_rear,
                                 Grammar* grammar) {
-    // log(1e-6) ≈ -13.81
-    const double kPenalty = -13.815510557964274;
     return entry_weight +
            (grammar ? grammar->Query(context, entry_text, is_rear) : kPenalty);
   }
+
+  // scores of words by the grammar, to be added to the entry weights.
+  inline static void EvaluateBatch(const string& context,
+                                   const string* const words[],
+                                   size_t num_words,
+                                   bool is_rear,
+                                   Grammar* grammar,
+                                   double scores[]) {
+    if (grammar) {
+      grammar->QueryBatch(context, words, num_words, is_rear, scores);
+    } else {
+      std::fill(scores, scores + num_words, kPenalty);
+    }
+  }
 };
 
 }  // namespace rime
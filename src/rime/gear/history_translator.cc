@@ -45,8 +45,8 @@ an<Translation> HistoryTranslator::Query(const string& input,
   for (; it != history.rend(); ++it) {
     if (it->type == "thru")
       continue;
-    auto candidate =
-        New<SimpleCandidate>(it->type, segment.start, segment.end, it->text);
+    auto candidate = NewPooled<SimpleCandidate>(it->type, segment.start,
+                                                segment.end, it->text);
     candidate->set_quality(initial_quality_);
     translation->Append(candidate);
     count++;
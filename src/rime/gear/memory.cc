@@ -104,6 +104,10 @@ bool Memory::FinishSession() {
   return user_dict_ && user_dict_->CommitPendingTransaction();
 }
 
+bool Memory::InSession() const {
+  return user_dict_ && user_dict_->HasPendingTransaction();
+}
+
 bool Memory::DiscardSession() {
   return user_dict_ && user_dict_->RevertRecentTransaction();
 }
@@ -44,6 +44,9 @@ class Memory {
   bool StartSession();
   bool FinishSession();
   bool DiscardSession();
+  // the session is finished in the next query, which writes the user
+  // dictionary shared with other translators.
+  bool InSession() const;
 
   Dictionary* dict() const { return dict_.get(); }
   UserDictionary* user_dict() const { return user_dict_.get(); }
@@ -0,0 +1,116 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <rime/config.h>
+#include <rime/resource.h>
+#include <rime/service.h>
+#include <rime/dict/db_pool_impl.h>
+#include <rime/gear/ngram_grammar.h>
+
+namespace rime {
+
+// the word following the last word of a sentence in compiled n-grams.
+static const char kEndOfSentence[] = "</s>";
+
+NgramGrammar::NgramGrammar(an<NgramDb> db, Config* config)
+    : db_(db),
+      max_history_length_(
+          (std::min)(size_t(db->max_history_length()), kMaxHistoryLength)),
+      end_of_sentence_hash_(NgramDb::HashString(kEndOfSentence)) {
+  if (config) {
+    config->GetDouble("grammar/non_collocation_penalty",
+                      &non_collocation_penalty_);
+    config->GetDouble("grammar/rear_penalty", &rear_penalty_);
+  }
+}
+
+double NgramGrammar::Query(const string& context,
+                           const string& word,
+                           bool is_rear) {
+  uint64_t histories[kMaxHistoryLength];
+  size_t num_histories = HashHistories(context, histories);
+  return Score(histories, num_histories, word, is_rear);
+}
+
+void NgramGrammar::QueryBatch(const string& context,
+                              const string* const words[],
+                              size_t num_words,
+                              bool is_rear,
+                              double scores[]) {
+  uint64_t histories[kMaxHistoryLength];
+  size_t num_histories = HashHistories(context, histories);
+  for (size_t i = 0; i < num_words; ++i) {
+    scores[i] = Score(histories, num_histories, *words[i], is_rear);
+  }
+}
+
+size_t NgramGrammar::HashHistories(const string& context,
+                                   uint64_t hashes[]) const {
+  // find where the trailing characters start, skipping UTF-8 continuation
+  // bytes, and list them from the longest.
+  size_t starts[kMaxHistoryLength];
+  size_t num_histories = 0;
+  for (size_t pos = context.length();
+       pos > 0 && num_histories < max_history_length_;) {
+    --pos;
+    if ((static_cast<uint8_t>(context[pos]) & 0xC0) != 0x80) {
+      starts[num_histories++] = pos;
+    }
+  }
+  for (size_t i = 0; i < num_histories; ++i) {
+    size_t start = starts[num_histories - 1 - i];
+    hashes[i] = NgramDb::HashString(context.data() + start,
+                                    context.length() - start);
+  }
+  return num_histories;
+}
+
+double NgramGrammar::Score(const uint64_t histories[],
+                           size_t num_histories,
+                           const string& word,
+                           bool is_rear) const {
+  uint64_t word_hash = NgramDb::HashString(word);
+  double score = non_collocation_penalty_;
+  for (size_t i = 0; i < num_histories; ++i) {
+    if (db_->Lookup(NgramDb::CombineKey(histories[i], word_hash), &score))
+      break;
+  }
+  if (is_rear) {
+    double rear_score = rear_penalty_;
+    db_->Lookup(NgramDb::CombineKey(word_hash, end_of_sentence_hash_),
+                &rear_score);
+    score += rear_score;
+  }
+  return score;
+}
+
+double NgramGrammar::MaxScore(bool is_rear) const {
+  double max_score = (std::max)(db_->max_score(), non_collocation_penalty_);
+  if (is_rear) {
+    max_score += (std::max)(db_->max_score(), rear_penalty_);
+  }
+  return max_score;
+}
+
+static const ResourceType kNgramDbResourceType = {"ngram_db", "",
+                                                  ".ngram.bin"};
+
+NgramGrammarComponent::NgramGrammarComponent()
+    : DbPool(the<ResourceResolver>(
+          Service::instance().CreateResourceResolver(kNgramDbResourceType))) {
+}
+
+NgramGrammar* NgramGrammarComponent::Create(Config* config) {
+  string language;
+  if (!config || !config->GetString("grammar/language", &language))
+    return nullptr;
+  auto db = GetDb(language);
+  if (!db->IsOpen() && (!db->Exists() || !db->Load()))
+    return nullptr;
+  return new NgramGrammar(db, config);
+}
+
+}  // namespace rime
@@ -0,0 +1,61 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_NGRAM_GRAMMAR_H_
+#define RIME_NGRAM_GRAMMAR_H_
+
+#include <rime/common.h>
+#include <rime/dict/db_pool.h>
+#include <rime/dict/ngram_db.h>
+#include <rime/gear/grammar.h>
+
+namespace rime {
+
+// Scores words by n-grams compiled with rime_grammar_compiler, matching the
+// longest n-gram history among the trailing characters of the context.
+//
+// grammar:
+//   language: zh-hant     # loads zh-hant.ngram.bin
+//   non_collocation_penalty: -13.8
+//   rear_penalty: 0
+class NgramGrammar : public Grammar {
+ public:
+  NgramGrammar(an<NgramDb> db, Config* config);
+
+  double Query(const string& context, const string& word, bool is_rear) override;
+  void QueryBatch(const string& context,
+                  const string* const words[],
+                  size_t num_words,
+                  bool is_rear,
+                  double scores[]) override;
+  double MaxScore(bool is_rear) const override;
+
+ private:
+  // hashes of the trailing characters of context, the longest first.
+  size_t HashHistories(const string& context, uint64_t hashes[]) const;
+  double Score(const uint64_t histories[],
+               size_t num_histories,
+               const string& word,
+               bool is_rear) const;
+
+  static constexpr size_t kMaxHistoryLength = 16;  // characters
+
+  an<NgramDb> db_;
+  size_t max_history_length_;
+  double non_collocation_penalty_ = kPenalty;
+  double rear_penalty_ = 0.0;
+  uint64_t end_of_sentence_hash_;
+};
+
+class NgramGrammarComponent : public NgramGrammar::Component,
+                              protected DbPool<NgramDb> {
+ public:
+  NgramGrammarComponent();
+  NgramGrammar* Create(Config* config) override;
+};
+
+}  // namespace rime
+
+#endif  // RIME_NGRAM_GRAMMAR_H_
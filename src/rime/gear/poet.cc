@@ -7,10 +7,13 @@
 // 2011-10-06 GONG Chen <chen.sst@gmail.com>
 //
 #include <algorithm>
+#include <array>
+#include <deque>
 #include <functional>
 #include <rime/candidate.h>
 #include <rime/config.h>
 #include <rime/dict/vocabulary.h>
+#include <rime/gear/cached_grammar.h>
 #include <rime/gear/grammar.h>
 #include <rime/gear/poet.h>
 
@@ -20,18 +23,23 @@ namespace rime {
 // the output line of the algorithm is transformed to an<Sentence>.
 struct Line {
   // be sure the pointer to predecessor Line object is stable. it works since
-  // pointer to values stored in std::map and std::unordered_map are stable.
+  // lines are kept in deques that only grow or shrink at the end.
   const Line* predecessor;
-  // as long as the word graph lives, pointers to entries are valid.
+  // as long as the word lattice kept by Poet lives, pointers to entries are
+  // valid.
   const DictEntry* entry;
   size_t end_pos;
   double weight;
+  size_t word_count;
 
   static const Line kEmpty;
 
   bool empty() const { return !predecessor && !entry; }
 
-  string last_word() const { return entry ? entry->text : string(); }
+  const string& last_word() const {
+    static const string kNoWord;
+    return entry ? entry->text : kNoWord;
+  }
 
   struct Components {
     vector<const Line*> lines;
@@ -56,25 +64,22 @@ struct Line {
                ? last_word()
                : predecessor->last_word() + last_word();
   }
-
-  vector<size_t> word_lengths() const {
-    vector<size_t> lengths;
-    size_t last_end_pos = 0;
-    for (const auto* c : components()) {
-      lengths.push_back(c->end_pos - last_end_pos);
-      last_end_pos = c->end_pos;
-    }
-    return lengths;
-  }
 };
 
-const Line Line::kEmpty{nullptr, nullptr, 0, 0.0};
+const Line Line::kEmpty{nullptr, nullptr, 0, 0.0, 0};
 
 inline static Grammar* create_grammar(Config* config) {
-  if (auto* grammar = Grammar::Require("grammar")) {
-    return grammar->Create(config);
+  auto* component = Grammar::Require("grammar");
+  if (!component)
+    return nullptr;
+  Grammar* grammar = component->Create(config);
+  int cache_size = CachedGrammar::kDefaultCapacity;
+  if (config)
+    config->GetInt("grammar/cache_size", &cache_size);
+  if (grammar && cache_size > 0) {
+    return new CachedGrammar(grammar, cache_size);
   }
-  return nullptr;
+  return grammar;
 }
 
 Poet::Poet(const Language* language, Config* config, Compare compare)
@@ -82,8 +87,6 @@ Poet::Poet(const Language* language, Config* config, Compare compare)
       grammar_(create_grammar(config)),
       compare_(compare) {}
 
-Poet::~Poet() {}
-
 bool Poet::CompareWeight(const Line& one, const Line& other) {
   return one.weight < other.weight;
 }
@@ -93,131 +96,376 @@ bool Poet::LeftAssociateCompare(const Line& one, const Line& other) {
   if (one.weight < other.weight)
     return true;
   if (one.weight == other.weight) {
-    auto one_word_lens = one.word_lengths();
-    auto other_word_lens = other.word_lengths();
     // less words is more favorable
-    if (one_word_lens.size() > other_word_lens.size())
+    if (one.word_count > other.word_count)
       return true;
-    if (one_word_lens.size() == other_word_lens.size()) {
-      return std::lexicographical_compare(
-          one_word_lens.begin(), one_word_lens.end(), other_word_lens.begin(),
-          other_word_lens.end());
+    if (one.word_count == other.word_count) {
+      // word lengths compare from left to right as the word boundaries do.
+      // walk back both lines in step; the first differing boundary is the
+      // last one found.
+      bool less = false;
+      for (const Line *x = &one, *y = &other; x != y && !x->empty();
+           x = x->predecessor, y = y->predecessor) {
+        if (x->end_pos != y->end_pos)
+          less = x->end_pos < y->end_pos;
+      }
+      return less;
     }
   }
   return false;
 }
 
-// keep the best line candidate per last phrase
-using LineCandidates = hash_map<string, Line>;
-
+// the top N candidates in descending order.
 template <int N>
-static vector<const Line*> find_top_candidates(const LineCandidates& candidates,
-                                               Poet::Compare compare) {
-  vector<const Line*> top;
-  top.reserve(N + 1);
-  for (const auto& candidate : candidates) {
+struct TopCandidates {
+  std::array<const Line*, N + 1> lines;
+  size_t size = 0;
+
+  const Line* const* begin() const { return lines.data(); }
+  const Line* const* end() const { return lines.data() + size; }
+
+  void Insert(const Line* candidate, const Poet::Compare& compare) {
     auto pos = std::upper_bound(
-        top.begin(), top.end(), &candidate.second,
+        lines.begin(), lines.begin() + size, candidate,
         [&](const Line* a, const Line* b) { return compare(*b, *a); });  // desc
-    if (pos - top.begin() >= N)
-      continue;
-    top.insert(pos, &candidate.second);
-    if (top.size() > N)
-      top.pop_back();
+    if (pos - lines.begin() >= N)
+      return;
+    std::move_backward(pos, lines.begin() + size, lines.begin() + size + 1);
+    *pos = candidate;
+    if (size < N)
+      ++size;
   }
-  return top;
-}
-
-using UpdateLineCandidate = function<void(const Line& candidate)>;
+};
 
+// keep the best line candidate per last phrase
 struct BeamSearch {
-  using State = LineCandidates;
-
   static constexpr int kMaxLineCandidates = 7;
 
-  static void Initiate(State& initial_state) {
-    initial_state.emplace("", Line::kEmpty);
+  // each line ending at a position is identified by the text of its last word,
+  // so that lines of the same (end position, last word) pair share a slot.
+  // these pairs are numbered in the order of end positions, which leaves no
+  // string keys to hash or copy during the search, and keeps the slots of
+  // lines to be made again in a tail that can be dropped before resuming.
+  void Resume(const WordLattice& words,
+              size_t resume_pos,
+              size_t num_positions) {
+    if (resume_pos == 0) {
+      lines_.clear();
+      slot_end_pos_.clear();
+      next_line_.clear();
+    }
+    while (!slot_end_pos_.empty() && slot_end_pos_.back() >= resume_pos) {
+      lines_.pop_back();
+      slot_end_pos_.pop_back();
+      next_line_.pop_back();
+    }
+    first_line_.resize(num_positions, kNoLine);
+    std::fill(first_line_.begin() + (std::min)(resume_pos, num_positions),
+              first_line_.end(), kNoLine);
+    if (lines_.empty()) {  // the initial line
+      lines_.push_back(Line::kEmpty);
+      slot_end_pos_.push_back(0);
+      next_line_.push_back(kNoLine);
+      first_line_[0] = 0;
+    }
+
+    // edges listed by end position; those ending before resume_pos have
+    // their lines kept, the rest are to make lines on.
+    vector<const WordLattice::Edge*> edges;
+    for (const auto& edge : words.edges()) {
+      edges.push_back(&edge);
+    }
+    std::stable_sort(
+        edges.begin(), edges.end(),
+        [](const WordLattice::Edge* a, const WordLattice::Edge* b) {
+          return a->end_pos < b->end_pos;
+        });
+    // open addressing with linear probing, at most half full.
+    size_t num_kept_slots = lines_.size();
+    size_t capacity = 2;
+    while (capacity < (words.num_entries() + num_kept_slots) * 2)
+      capacity *= 2;
+    struct Bucket {
+      const string* text = nullptr;
+      size_t end_pos = 0;
+      size_t slot = 0;
+    };
+    vector<Bucket> buckets(capacity);
+    std::hash<string> hash_text;
+    auto find_bucket = [&](const string& text, size_t end_pos) -> Bucket& {
+      size_t i = (hash_text(text) ^ end_pos) & (capacity - 1);
+      while (buckets[i].text &&
+             (buckets[i].end_pos != end_pos || *buckets[i].text != text)) {
+        i = (i + 1) & (capacity - 1);
+      }
+      return buckets[i];
+    };
+    // kept slots are found by the last words of their lines, since entries
+    // are numbered anew in each lattice.
+    for (size_t slot = 0; slot < num_kept_slots; ++slot) {
+      if (!lines_[slot].empty()) {
+        const string& text = lines_[slot].last_word();
+        find_bucket(text, slot_end_pos_[slot]) = {&text, slot_end_pos_[slot],
+                                                  slot};
+      }
+    }
+    slots_.assign(words.num_entries(), kNoLine);
+    size_t num_slots = num_kept_slots;
+    for (const auto* edge : edges) {
+      size_t end_pos = edge->end_pos;
+      bool kept = end_pos < resume_pos;
+      for (size_t entry_index = edge->begin; entry_index < edge->end;
+           ++entry_index) {
+        const auto& entry = words.entry(entry_index);
+        Bucket& bucket = find_bucket(entry->text, end_pos);
+        if (!bucket.text) {
+          if (kept)  // made no line
+            continue;
+          bucket = {&entry->text, end_pos, num_slots++};
+          slot_end_pos_.push_back(end_pos);
+        }
+        slots_[entry_index] = bucket.slot;
+      }
+    }
+    lines_.resize(num_slots, Line::kEmpty);
+    next_line_.resize(num_slots, kNoLine);
   }
 
-  static void ForEachCandidate(const State& state,
-                               Poet::Compare compare,
-                               UpdateLineCandidate update) {
-    auto top_candidates =
-        find_top_candidates<kMaxLineCandidates>(state, compare);
+  bool HasState(size_t pos) const { return first_line_[pos] != kNoLine; }
+
+  template <class UpdateLineCandidate>
+  void ForEachCandidate(size_t pos,
+                        const Poet::Compare& compare,
+                        UpdateLineCandidate update) const {
+    TopCandidates<kMaxLineCandidates> top_candidates;
+    for (size_t i = first_line_[pos]; i != kNoLine; i = next_line_[i]) {
+      top_candidates.Insert(&lines_[i], compare);
+    }
     for (const auto* candidate : top_candidates) {
       update(*candidate);
     }
   }
 
-  static Line& BestLineToUpdate(State& state, const Line& new_line) {
-    const auto& key = new_line.last_word();
-    return state[key];
+  Line& BestLineToUpdate(size_t end_pos, size_t entry_index) {
+    size_t slot = slots_[entry_index];
+    Line& best = lines_[slot];
+    if (best.empty()) {  // first line in the slot
+      next_line_[slot] = first_line_[end_pos];
+      first_line_[end_pos] = slot;
+    }
+    return best;
+  }
+
+  // the line an entry would update, or nullptr if it hasn't been made.
+  const Line* LineOfEntry(size_t end_pos, size_t entry_index) const {
+    size_t slot = slots_[entry_index];
+    return slot != kNoLine && !lines_[slot].empty() ? &lines_[slot] : nullptr;
   }
 
-  static const Line& BestLineInState(const State& final_state,
-                                     Poet::Compare compare) {
+  const Line* BestLineInState(size_t pos, const Poet::Compare& compare) const {
     const Line* best = nullptr;
-    for (const auto& candidate : final_state) {
-      if (!best || compare(*best, candidate.second)) {
-        best = &candidate.second;
+    for (size_t i = first_line_[pos]; i != kNoLine; i = next_line_[i]) {
+      if (!best || compare(*best, lines_[i])) {
+        best = &lines_[i];
       }
     }
-    return best ? *best : Line::kEmpty;
+    return best;
   }
+
+ private:
+  static constexpr size_t kNoLine = size_t(-1);
+
+  // slot of each entry of the word lattice.
+  vector<size_t> slots_;
+  // lines never move once allocated, as a deque only grows or shrinks at the
+  // end; the first one is the initial line.
+  std::deque<Line> lines_;
+  vector<size_t> slot_end_pos_;
+  // lines ending at each position are linked in a list.
+  vector<size_t> first_line_;
+  vector<size_t> next_line_;
 };
 
 struct DynamicProgramming {
-  using State = Line;
+  void Resume(const WordLattice& words,
+              size_t resume_pos,
+              size_t num_positions) {
+    if (resume_pos == 0)
+      states_.clear();
+    states_.resize((std::min)(resume_pos, num_positions), Line::kEmpty);
+    states_.resize(num_positions, Line::kEmpty);
+  }
 
-  static void Initiate(State& initial_state) { initial_state = Line::kEmpty; }
+  bool HasState(size_t pos) const { return pos == 0 || !states_[pos].empty(); }
 
-  static void ForEachCandidate(const State& state,
-                               Poet::Compare compare,
-                               UpdateLineCandidate update) {
-    update(state);
+  template <class UpdateLineCandidate>
+  void ForEachCandidate(size_t pos,
+                        const Poet::Compare& compare,
+                        UpdateLineCandidate update) const {
+    update(states_[pos]);
   }
 
-  static Line& BestLineToUpdate(State& state, const Line& new_line) {
-    return state;
+  Line& BestLineToUpdate(size_t end_pos, size_t entry_index) {
+    return states_[end_pos];
   }
 
-  static const Line& BestLineInState(const State& final_state,
-                                     Poet::Compare compare) {
-    return final_state;
+  const Line* LineOfEntry(size_t end_pos, size_t entry_index) const {
+    return !states_[end_pos].empty() ? &states_[end_pos] : nullptr;
   }
+
+  const Line* BestLineInState(size_t pos, const Poet::Compare& compare) const {
+    return &states_[pos];
+  }
+
+ private:
+  // resized only at the end, so that lines can refer to their predecessors.
+  std::deque<Line> states_;
+};
+
+// lines made of the last word lattice, kept to resume making sentences on
+// the next one from the first position where they differ.
+struct Poet::Lattice {
+  virtual ~Lattice() = default;
+
+  WordLattice words;
+  size_t total_length = 0;
+  string preceding_text;
+};
+
+template <class Strategy>
+struct Poet::LatticeWithStrategy : Poet::Lattice {
+  Strategy strategy;
 };
 
+static bool SameEntry(const DictEntry& a, const DictEntry& b) {
+  return a.text == b.text && a.weight == b.weight && a.code == b.code &&
+         a.comment == b.comment && a.preedit == b.preedit &&
+         a.custom_code == b.custom_code && a.quality_len == b.quality_len &&
+         a.commit_count == b.commit_count &&
+         a.remaining_code_length == b.remaining_code_length &&
+         a.matching_code_size == b.matching_code_size;
+}
+
+static bool SameEntries(const WordLattice& one,
+                        const WordLattice::Edge* edge,
+                        const WordLattice& other,
+                        const WordLattice::Edge* other_edge) {
+  size_t size = edge ? edge->size() : 0;
+  if (size != (other_edge ? other_edge->size() : 0))
+    return false;
+  for (size_t i = 0; i < size; ++i) {
+    const auto& a = one.entry(edge->begin + i);
+    const auto& b = other.entry(other_edge->begin + i);
+    if (a != b && !SameEntry(*a, *b))
+      return false;
+  }
+  return true;
+}
+
+// lines ending before the returned position are made of edges found in both
+// lattices with the same entries, so they need not be made again.
+static size_t FirstAffectedPosition(const WordLattice& one,
+                                    const WordLattice& other,
+                                    size_t limit) {
+  for (const auto* words : {&one, &other}) {
+    const WordLattice& another = words == &one ? other : one;
+    for (const auto& edge : words->edges()) {
+      if (size_t(edge.start_pos) >= limit)
+        break;
+      if (size_t(edge.end_pos) >= limit)
+        continue;
+      const auto* another_edge = another.FindEdge(edge.start_pos, edge.end_pos);
+      if (!SameEntries(*words, &edge, another, another_edge)) {
+        limit = edge.end_pos;
+      }
+    }
+  }
+  return limit;
+}
+
 template <class Strategy>
-an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
-                                            size_t total_length,
-                                            const string& preceding_text) {
-  map<int, typename Strategy::State> states;
-  Strategy::Initiate(states[0]);
-  for (const auto& sv : graph) {
-    size_t start_pos = sv.first;
-    if (states.find(start_pos) == states.end())
+const Line* Poet::MakeLinesWithStrategy(WordLattice words,
+                                        size_t total_length,
+                                        const string& preceding_text) {
+  size_t num_positions = (std::max)(total_length + 1, words.num_positions());
+  if (!lattice_ || lattice_.use_count() > 1)
+    lattice_ = New<LatticeWithStrategy<Strategy>>();
+  auto& lattice = static_cast<LatticeWithStrategy<Strategy>&>(*lattice_);
+  // the rear word and the single word excluded from the result are decided
+  // by the total length, so lines ending there are always made again.
+  size_t resume_pos =
+      lattice.preceding_text != preceding_text
+          ? 0
+          : FirstAffectedPosition(lattice.words, words,
+                                  (std::min)(lattice.total_length,
+                                             total_length));
+  DLOG(INFO) << "resume making sentence at pos: " << resume_pos;
+  // retained lines refer to entries of the last lattice, which are kept in
+  // place of the equal entries of the new one.
+  std::swap(lattice.words, words);
+  WordLattice& last_words = words;
+  for (const auto& edge : lattice.words.edges()) {
+    if (size_t(edge.start_pos) >= resume_pos)
+      break;
+    if (size_t(edge.end_pos) >= resume_pos)
+      continue;
+    const auto* last_edge = last_words.FindEdge(edge.start_pos, edge.end_pos);
+    for (size_t i = 0; i < edge.size(); ++i) {
+      lattice.words.entry(edge.begin + i).swap(
+          last_words.entry(last_edge->begin + i));
+    }
+  }
+  lattice.total_length = total_length;
+  lattice.preceding_text = preceding_text;
+  Strategy& strategy = lattice.strategy;
+  strategy.Resume(lattice.words, resume_pos, num_positions);
+  // texts of entries, to be scored by the grammar in batches of one edge.
+  vector<const string*> texts;
+  texts.reserve(lattice.words.num_entries());
+  for (size_t i = 0; i < lattice.words.num_entries(); ++i) {
+    texts.push_back(&lattice.words.entry(i)->text);
+  }
+  size_t max_edge_size = 0;
+  for (const auto& edge : lattice.words.edges()) {
+    max_edge_size = (std::max)(max_edge_size, edge.size());
+  }
+  vector<double> scores(max_edge_size);
+  const auto& edges = lattice.words.edges();
+  for (auto next_edge = edges.begin(); next_edge != edges.end();) {
+    size_t start_pos = next_edge->start_pos;
+    // skip edges ending before the resumed position.
+    auto first_edge = next_edge;
+    while (next_edge != edges.end() &&
+           size_t(next_edge->start_pos) == start_pos) {
+      if (size_t(next_edge->end_pos) < resume_pos)
+        first_edge = next_edge + 1;
+      ++next_edge;
+    }
+    auto last_edge = next_edge;
+    if (first_edge == last_edge || !strategy.HasState(start_pos))
       continue;
     DLOG(INFO) << "start pos: " << start_pos;
-    const auto& source_state = states[start_pos];
-    const auto update = [this, &states, &sv, start_pos, total_length,
+    const auto update = [this, &strategy, &lattice, first_edge, last_edge,
+                         &texts, &scores, start_pos, total_length,
                          &preceding_text](const Line& candidate) {
-      for (const auto& ev : sv.second) {
-        size_t end_pos = ev.first;
+      const string context =
+          candidate.empty() ? preceding_text : candidate.context();
+      for (auto edge = first_edge; edge != last_edge; ++edge) {
+        size_t end_pos = edge->end_pos;
+        // extend candidates with dict entries on a valid edge.
         if (start_pos == 0 && end_pos == total_length)
           continue;  // exclude single word from the result
         DLOG(INFO) << "end pos: " << end_pos;
         bool is_rear = end_pos == total_length;
-        auto& target_state = states[end_pos];
-        // extend candidates with dict entries on a valid edge.
-        const DictEntryList& entries = ev.second;
-        for (const auto& entry : entries) {
-          const string& context =
-              candidate.empty() ? preceding_text : candidate.context();
-          double weight = candidate.weight +
-                          Grammar::Evaluate(context, entry->text, entry->weight,
-                                            is_rear, grammar_.get());
-          Line new_line{&candidate, entry.get(), end_pos, weight};
-          Line& best = Strategy::BestLineToUpdate(target_state, new_line);
+        Grammar::EvaluateBatch(context, &texts[edge->begin], edge->size(),
+                               is_rear, grammar_.get(), scores.data());
+        for (size_t i = 0; i < edge->size(); ++i) {
+          size_t entry_index = edge->begin + i;
+          const auto& entry = lattice.words.entry(entry_index);
+          double weight = candidate.weight + (entry->weight + scores[i]);
+          Line new_line{&candidate, entry.get(), end_pos, weight,
+                        candidate.word_count + 1};
+          Line& best = strategy.BestLineToUpdate(end_pos, entry_index);
           if (best.empty() || compare_(best, new_line)) {
             DLOG(INFO) << "updated line ending at " << end_pos
                        << " with text: ..." << new_line.last_word()
@@ -227,14 +475,17 @@ an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
         }
       }
     };
-    Strategy::ForEachCandidate(source_state, compare_, update);
+    strategy.ForEachCandidate(start_pos, compare_, update);
   }
-  auto found = states.find(total_length);
-  if (found == states.end() || found->second.empty())
+  if (!strategy.HasState(total_length))
     return nullptr;
-  const Line& best = Strategy::BestLineInState(found->second, compare_);
-  auto sentence = New<Sentence>(language_);
-  for (const auto* c : best.components()) {
+  const Line* best = strategy.BestLineInState(total_length, compare_);
+  return best && !best->empty() ? best : nullptr;
+}
+
+an<Sentence> Poet::ToSentence(const Line* line) const {
+  auto sentence = NewPooled<Sentence>(language_);
+  for (const auto* c : line->components()) {
     if (!c->entry)
       continue;
     sentence->Extend(*c->entry, c->end_pos, c->weight);
@@ -242,13 +493,259 @@ an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
   return sentence;
 }
 
-an<Sentence> Poet::MakeSentence(const WordGraph& graph,
+// yields sentences made of the lines kept in a lattice, in the way of the
+// lazy k-best algorithm on hypergraphs (Huang and Chiang, 2005): the kept
+// line of a state is its best derivation, and the next best one extends the
+// next best derivation of one of its predecessors.
+template <class Strategy>
+class Poet::KBestTranslation : public Translation {
+ public:
+  KBestTranslation(const Poet* poet,
+                   an<LatticeWithStrategy<Strategy>> lattice,
+                   size_t start);
+
+  bool Next() override;
+  an<Candidate> Peek() override;
+
+ private:
+  struct Node;
+  struct Derivation {
+    Line line;
+    Node* predecessor;
+    size_t predecessor_index;
+  };
+  struct Node {
+    // derivations found so far, the best first.
+    vector<const Line*> lines;
+    vector<Derivation> queue;  // a heap of the next best derivations
+    bool expanded = false;
+  };
+  Node& NodeOf(const Line* line);
+  // makes the k-th best derivation of a node, counting from 0.
+  bool Fetch(Node& node, size_t k);
+  void Expand(Node& node);
+  void Enqueue(vector<Derivation>& queue,
+               Node& predecessor,
+               size_t predecessor_index,
+               const DictEntry* entry,
+               size_t end_pos);
+  bool FindNextSentence();
+
+  const Poet* poet_;
+  an<LatticeWithStrategy<Strategy>> lattice_;
+  size_t start_;
+  vector<const WordLattice::Edge*> edges_;  // ordered by end position
+  hash_map<const Line*, Node> nodes_;
+  std::deque<Line> lines_;
+  // lines ending at total_length, with the index of their next derivation.
+  vector<pair<Node*, size_t>> ends_;
+  const Line* line_ = nullptr;
+  an<Sentence> sentence_;
+  hash_set<string> texts_;
+};
+
+template <class Strategy>
+Poet::KBestTranslation<Strategy>::KBestTranslation(
+    const Poet* poet,
+    an<LatticeWithStrategy<Strategy>> lattice,
+    size_t start)
+    : poet_(poet), lattice_(lattice), start_(start) {
+  for (const auto& edge : lattice_->words.edges()) {
+    edges_.push_back(&edge);
+  }
+  std::stable_sort(
+      edges_.begin(), edges_.end(),
+      [](const WordLattice::Edge* a, const WordLattice::Edge* b) {
+        return a->end_pos < b->end_pos;
+      });
+  const Strategy& strategy = lattice_->strategy;
+  if (strategy.HasState(lattice_->total_length)) {
+    strategy.ForEachCandidate(lattice_->total_length, poet_->compare_,
+                              [this](const Line& line) {
+                                if (!line.empty())
+                                  ends_.emplace_back(&NodeOf(&line), 0);
+                              });
+  }
+  set_exhausted(!FindNextSentence());
+}
+
+template <class Strategy>
+bool Poet::KBestTranslation<Strategy>::Next() {
+  if (exhausted())
+    return false;
+  sentence_.reset();
+  set_exhausted(!FindNextSentence());
+  return true;
+}
+
+template <class Strategy>
+an<Candidate> Poet::KBestTranslation<Strategy>::Peek() {
+  if (exhausted())
+    return nullptr;
+  if (!sentence_) {
+    sentence_ = poet_->ToSentence(line_);
+    sentence_->Offset(start_);
+  }
+  return sentence_;
+}
+
+template <class Strategy>
+bool Poet::KBestTranslation<Strategy>::FindNextSentence() {
+  const auto& compare = poet_->compare_;
+  while (true) {
+    pair<Node*, size_t>* best = nullptr;
+    for (auto& end : ends_) {
+      if (!Fetch(*end.first, end.second))
+        continue;
+      if (!best || compare(*best->first->lines[best->second],
+                           *end.first->lines[end.second])) {
+        best = &end;
+      }
+    }
+    if (!best)
+      return false;
+    line_ = best->first->lines[best->second++];
+    // different segmentations may make the same text.
+    string text;
+    for (const auto* c : line_->components()) {
+      if (c->entry)
+        text += c->entry->text;
+    }
+    if (texts_.insert(text).second)
+      return true;
+  }
+}
+
+template <class Strategy>
+typename Poet::KBestTranslation<Strategy>::Node&
+Poet::KBestTranslation<Strategy>::NodeOf(const Line* line) {
+  Node& node = nodes_[line];
+  if (node.lines.empty())
+    node.lines.push_back(line);
+  return node;
+}
+
+template <class Strategy>
+bool Poet::KBestTranslation<Strategy>::Fetch(Node& node, size_t k) {
+  const auto& compare = poet_->compare_;
+  const auto less = [&compare](const Derivation& a, const Derivation& b) {
+    return compare(a.line, b.line);
+  };
+  while (node.lines.size() <= k) {
+    if (!node.expanded)
+      Expand(node);
+    if (node.queue.empty())
+      return false;
+    std::pop_heap(node.queue.begin(), node.queue.end(), less);
+    Derivation next = node.queue.back();
+    node.queue.pop_back();
+    lines_.push_back(next.line);
+    node.lines.push_back(&lines_.back());
+    Enqueue(node.queue, *next.predecessor, next.predecessor_index + 1,
+            next.line.entry, next.line.end_pos);
+  }
+  return true;
+}
+
+template <class Strategy>
+void Poet::KBestTranslation<Strategy>::Expand(Node& node) {
+  node.expanded = true;
+  const Line* best = node.lines[0];
+  if (best->empty())
+    return;  // the initial line
+  const Strategy& strategy = lattice_->strategy;
+  size_t end_pos = best->end_pos;
+  auto first = std::lower_bound(
+      edges_.begin(), edges_.end(), end_pos,
+      [](const WordLattice::Edge* edge, size_t pos) {
+        return size_t(edge->end_pos) < pos;
+      });
+  auto last = std::upper_bound(
+      first, edges_.end(), end_pos,
+      [](size_t pos, const WordLattice::Edge* edge) {
+        return pos < size_t(edge->end_pos);
+      });
+  for (auto it = first; it != last; ++it) {
+    const WordLattice::Edge* edge = *it;
+    if (edge->start_pos == 0 && end_pos == lattice_->total_length)
+      continue;  // single word is excluded from the result
+    if (!strategy.HasState(edge->start_pos))
+      continue;
+    for (size_t i = edge->begin; i < edge->end; ++i) {
+      if (strategy.LineOfEntry(end_pos, i) != best)
+        continue;
+      const DictEntry* entry = lattice_->words.entry(i).get();
+      strategy.ForEachCandidate(
+          edge->start_pos, poet_->compare_, [&](const Line& predecessor) {
+            // the best derivation is already there; go on with the next one.
+            bool is_best =
+                &predecessor == best->predecessor && entry == best->entry;
+            Enqueue(node.queue, NodeOf(&predecessor), is_best ? 1 : 0, entry,
+                    end_pos);
+          });
+    }
+  }
+}
+
+template <class Strategy>
+void Poet::KBestTranslation<Strategy>::Enqueue(vector<Derivation>& queue,
+                                               Node& predecessor,
+                                               size_t predecessor_index,
+                                               const DictEntry* entry,
+                                               size_t end_pos) {
+  if (!Fetch(predecessor, predecessor_index))
+    return;
+  const Line* candidate = predecessor.lines[predecessor_index];
+  const string context =
+      candidate->empty() ? lattice_->preceding_text : candidate->context();
+  bool is_rear = end_pos == lattice_->total_length;
+  double weight =
+      candidate->weight + Grammar::Evaluate(context, entry->text, entry->weight,
+                                            is_rear, poet_->grammar_.get());
+  queue.push_back({Line{candidate, entry, end_pos, weight,
+                        candidate->word_count + 1},
+                   &predecessor, predecessor_index});
+  const auto& compare = poet_->compare_;
+  std::push_heap(queue.begin(), queue.end(),
+                 [&compare](const Derivation& a, const Derivation& b) {
+                   return compare(a.line, b.line);
+                 });
+}
+
+template <class Strategy>
+an<Translation> Poet::MakeSentencesWithStrategy(WordLattice words,
+                                                size_t total_length,
+                                                const string& preceding_text,
+                                                size_t start) {
+  if (!MakeLinesWithStrategy<Strategy>(std::move(words), total_length,
+                                       preceding_text))
+    return nullptr;
+  return New<KBestTranslation<Strategy>>(
+      this, std::static_pointer_cast<LatticeWithStrategy<Strategy>>(lattice_),
+      start);
+}
+
+Poet::~Poet() {}
+
+an<Sentence> Poet::MakeSentence(WordLattice words,
                                 size_t total_length,
                                 const string& preceding_text) {
-  return grammar_ ? MakeSentenceWithStrategy<BeamSearch>(graph, total_length,
-                                                         preceding_text)
-                  : MakeSentenceWithStrategy<DynamicProgramming>(
-                        graph, total_length, preceding_text);
+  const Line* best =
+      grammar_ ? MakeLinesWithStrategy<BeamSearch>(
+                     std::move(words), total_length, preceding_text)
+               : MakeLinesWithStrategy<DynamicProgramming>(
+                     std::move(words), total_length, preceding_text);
+  return best ? ToSentence(best) : nullptr;
+}
+
+an<Translation> Poet::MakeSentences(WordLattice words,
+                                    size_t total_length,
+                                    const string& preceding_text,
+                                    size_t start) {
+  return grammar_ ? MakeSentencesWithStrategy<BeamSearch>(
+                        std::move(words), total_length, preceding_text, start)
+                  : MakeSentencesWithStrategy<DynamicProgramming>(
+                        std::move(words), total_length, preceding_text, start);
 }
 
 }  // namespace rime
@@ -14,11 +14,10 @@
 #include <rime/translation.h>
 #include <rime/gear/translator_commons.h>
 #include <rime/gear/contextual_translation.h>
+#include <rime/gear/word_lattice.h>
 
 namespace rime {
 
-using WordGraph = map<int, map<int, DictEntryList>>;
-
 class Grammar;
 class Language;
 struct Line;
@@ -36,9 +35,15 @@ class Poet {
        Compare compare = CompareWeight);
   ~Poet();
 
-  an<Sentence> MakeSentence(const WordGraph& graph,
+  an<Sentence> MakeSentence(WordLattice words,
                             size_t total_length,
                             const string& preceding_text);
+  // yields sentences from the best one on, each making only the next sentence
+  // when asked for. sentences are offset to start at `start`.
+  an<Translation> MakeSentences(WordLattice words,
+                                size_t total_length,
+                                const string& preceding_text,
+                                size_t start = 0);
 
   template <class TranslatorT>
   an<Translation> ContextualWeighted(an<Translation> translation,
@@ -57,14 +62,30 @@ class Poet {
   }
 
  private:
+  struct Lattice;
+  template <class Strategy>
+  struct LatticeWithStrategy;
+  template <class Strategy>
+  class KBestTranslation;
+
+  // returns the best line ending at total_length, if any.
+  template <class Strategy>
+  const Line* MakeLinesWithStrategy(WordLattice words,
+                                    size_t total_length,
+                                    const string& preceding_text);
   template <class Strategy>
-  an<Sentence> MakeSentenceWithStrategy(const WordGraph& graph,
-                                        size_t total_length,
-                                        const string& preceding_text);
+  an<Translation> MakeSentencesWithStrategy(WordLattice words,
+                                            size_t total_length,
+                                            const string& preceding_text,
+                                            size_t start);
+  an<Sentence> ToSentence(const Line* line) const;
 
   const Language* language_;
   the<Grammar> grammar_;
   Compare compare_;
+  // lines made for the last call, to resume from on the next call unless
+  // shared with a KBestTranslation.
+  an<Lattice> lattice_;
 };
 
 }  // namespace rime
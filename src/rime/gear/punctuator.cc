@@ -306,11 +306,12 @@ an<Candidate> CreatePunctCandidate(const string& punct,
                     is_hangul || is_full_shape_narrow_symbol || is_wide_symbol;
   }
   bool one_key = (segment.end - segment.start == 1);
-  return New<SimpleCandidate>("punct", segment.start, segment.end, punct,
-                              (is_half_shape   ? half_shape
-                               : is_full_shape ? full_shape
-                                               : ""),
-                              one_key ? punct : "");
+  return NewPooled<SimpleCandidate>("punct", segment.start, segment.end,
+                                    punct,
+                                    (is_half_shape   ? half_shape
+                                     : is_full_shape ? full_shape
+                                                     : ""),
+                                    one_key ? punct : "");
 }
 
 an<Translation> PunctTranslator::Query(const string& input,
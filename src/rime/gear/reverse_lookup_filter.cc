@@ -14,23 +14,29 @@
 
 namespace rime {
 
-class ReverseLookupFilterTranslation : public CacheTranslation {
+// annotates each candidate once, as it is reached; no more candidates are
+// pulled from the inner translation than those asked for.
+class ReverseLookupFilterTranslation : public PrefetchTranslation {
  public:
   ReverseLookupFilterTranslation(an<Translation> translation,
                                  ReverseLookupFilter* filter)
-      : CacheTranslation(translation), filter_(filter) {}
-  virtual an<Candidate> Peek();
+      : PrefetchTranslation(translation), filter_(filter) {}
 
  protected:
+  virtual bool Replenish();
+
   ReverseLookupFilter* filter_;
 };
 
-an<Candidate> ReverseLookupFilterTranslation::Peek() {
-  auto cand = CacheTranslation::Peek();
-  if (cand) {
+bool ReverseLookupFilterTranslation::Replenish() {
+  if (translation_->exhausted())
+    return false;
+  if (auto cand = translation_->Peek()) {
     filter_->Process(cand);
+    cache_.push_back(cand);
   }
-  return cand;
+  translation_->Next();
+  return !cache_.empty();
 }
 
 ReverseLookupFilter::ReverseLookupFilter(const Ticket& ticket)
@@ -55,6 +61,7 @@ void ReverseLookupFilter::Initialize() {
     config->GetBool(name_space_ + "/overwrite_comment", &overwrite_comment_);
     config->GetBool(name_space_ + "/append_comment", &append_comment_);
     comment_formatter_.Load(config->GetList(name_space_ + "/comment_format"));
+    comment_formatter_.EnableMemo();
   }
 }
 
@@ -70,20 +77,35 @@ an<Translation> ReverseLookupFilter::Apply(an<Translation> translation,
 }
 
 void ReverseLookupFilter::Process(const an<Candidate>& cand) {
-  if (!cand->comment().empty() && !(overwrite_comment_ || append_comment_))
-    return;
-  auto phrase = As<Phrase>(Candidate::GetGenuineCandidate(cand));
-  if (!phrase)
+  Process(CandidateList{cand});
+}
+
+void ReverseLookupFilter::Process(const CandidateList& candidates) {
+  CandidateList annotated;
+  vector<an<Phrase>> phrases;
+  vector<string> texts;
+  for (const auto& cand : candidates) {
+    if (!cand->comment().empty() && !(overwrite_comment_ || append_comment_))
+      continue;
+    auto phrase = As<Phrase>(Candidate::GetGenuineCandidate(cand));
+    if (!phrase)
+      continue;
+    annotated.push_back(cand);
+    phrases.push_back(phrase);
+    texts.push_back(phrase->text());
+  }
+  if (texts.empty())
     return;
-  string codes;
-  if (rev_dict_->ReverseLookup(phrase->text(), &codes)) {
-    comment_formatter_.Apply(&codes);
-    if (!codes.empty()) {
-      if (overwrite_comment_ || cand->comment().empty()) {
-        phrase->set_comment(codes);
-      } else {
-        phrase->set_comment(cand->comment() + " " + codes);
-      }
+  vector<string> comments;
+  rev_dict_->LookupComments(texts, &comment_formatter_, &comments);
+  for (size_t i = 0; i < texts.size(); ++i) {
+    const string& codes = comments[i];
+    if (codes.empty())
+      continue;
+    if (overwrite_comment_ || annotated[i]->comment().empty()) {
+      phrases[i]->set_comment(codes);
+    } else {
+      phrases[i]->set_comment(annotated[i]->comment() + " " + codes);
     }
   }
 }
@@ -7,6 +7,7 @@
 #ifndef RIME_REVERSE_LOOKUP_FILTER_H_
 #define RIME_REVERSE_LOOKUP_FILTER_H_
 
+#include <rime/candidate.h>
 #include <rime/common.h>
 #include <rime/filter.h>
 #include <rime/algo/algebra.h>
@@ -26,6 +27,8 @@ class ReverseLookupFilter : public Filter, TagMatching {
   virtual bool AppliesToSegment(Segment* segment) { return TagsMatch(segment); }
 
   void Process(const an<Candidate>& cand);
+  // looks up comments of a batch of candidates at once.
+  void Process(const CandidateList& candidates);
 
  protected:
   void Initialize();
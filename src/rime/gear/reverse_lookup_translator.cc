@@ -58,18 +58,21 @@ an<Candidate> ReverseLookupTranslation::Peek() {
     return nullptr;
   const auto& entry(iter_.Peek());
   string tips;
-  if (dict_) {
+  if (dict_ && options_) {
+    vector<string> comments;
+    dict_->LookupComments({entry->text}, &options_->comment_formatter(),
+                          &comments);
+    tips = comments.front();
+  } else if (dict_) {
     dict_->ReverseLookup(entry->text, &tips);
-    if (options_) {
-      options_->comment_formatter().Apply(&tips);
-    }
-    // if (!tips.empty()) {
-    //   boost::algorithm::replace_all(tips, " ", separator);
-    // }
   }
+  // if (!tips.empty()) {
+  //   boost::algorithm::replace_all(tips, " ", separator);
+  // }
   an<Candidate> cand =
-      New<SimpleCandidate>("reverse_lookup", start_, end_, entry->text,
-                           !tips.empty() ? tips : entry->comment, preedit_);
+      NewPooled<SimpleCandidate>("reverse_lookup", start_, end_, entry->text,
+                                 !tips.empty() ? tips : entry->comment,
+                                 preedit_);
   return cand;
 }
 
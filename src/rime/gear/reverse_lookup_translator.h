@@ -22,6 +22,8 @@ class ReverseLookupTranslator : public Translator {
   ReverseLookupTranslator(const Ticket& ticket);
 
   virtual an<Translation> Query(const string& input, const Segment& segment);
+  // dictionaries are loaded in the first query, on the engine's thread.
+  bool concurrent_query() const override { return initialized_; }
 
  protected:
   void Initialize();
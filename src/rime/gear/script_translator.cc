@@ -24,6 +24,7 @@
 #include <rime/dict/corrector.h>
 #include <rime/dict/dictionary.h>
 #include <rime/dict/user_dictionary.h>
+#include <rime/gear/charset_filter.h>
 #include <rime/gear/poet.h>
 #include <rime/gear/script_translator.h>
 #include <rime/gear/translator_commons.h>
@@ -115,11 +116,13 @@ class ScriptTranslation : public Translation {
                     Poet* poet,
                     const string& input,
                     size_t start,
-                    size_t end_of_input)
+                    size_t end_of_input,
+                    bool filter_by_charset)
       : translator_(translator),
         poet_(poet),
         start_(start),
         end_of_input_(end_of_input),
+        filter_by_charset_(filter_by_charset),
         syllabifier_(
             New<ScriptSyllabifier>(translator, corrector, input, start)),
         enable_correction_(corrector) {
@@ -134,19 +137,27 @@ class ScriptTranslation : public Translation {
   bool IsNormalSpelling() const;
   bool PrepareCandidate();
   template <class QueryResult>
-  void EnrollEntries(map<int, DictEntryList>& entries_by_end_pos,
+  void EnrollEntries(WordLattice& words,
+                     int start_pos,
                      const an<QueryResult>& query_result);
   an<Sentence> MakeSentence(Dictionary* dict, UserDictionary* user_dict);
+  an<Sentence> NextSentence();
+  an<UserDictEntryCollector> FilterByCharset(
+      an<UserDictEntryCollector> collector);
 
   ScriptTranslator* translator_;
   Poet* poet_;
   size_t start_;
   size_t end_of_input_;
+  bool filter_by_charset_;
   an<ScriptSyllabifier> syllabifier_;
 
   an<DictEntryCollector> phrase_;
   an<UserDictEntryCollector> user_phrase_;
   an<Sentence> sentence_;
+  // the next best sentences, if more than one is asked for.
+  an<Translation> more_sentences_;
+  int sentence_count_ = 0;
 
   an<Phrase> candidate_ = nullptr;
   size_t candidate_index_ = 0;
@@ -185,6 +196,8 @@ ScriptTranslator::ScriptTranslator(const Ticket& ticket)
       enable_word_completion_ = enable_completion_;
     }
     config->GetInt(name_space_ + "/max_homophones", &max_homophones_);
+    config->GetBool(name_space_ + "/enable_charset_filter",
+                    &enable_charset_filter_);
     poet_.reset(new Poet(language(), config));
   }
   if (enable_correction_) {
@@ -209,9 +222,12 @@ an<Translation> ScriptTranslator::Query(const string& input,
       user_dict_ && user_dict_->loaded() && !IsUserDictDisabledFor(input);
 
   size_t end_of_input = engine_->context()->input().length();
+  bool filter_by_charset = enable_charset_filter_ &&
+                           !engine_->context()->get_option("extended_charset");
   // the translator should survive translations it creates
-  auto result = New<ScriptTranslation>(this, corrector_.get(), poet_.get(),
-                                       input, segment.start, end_of_input);
+  auto result =
+      New<ScriptTranslation>(this, corrector_.get(), poet_.get(), input,
+                             segment.start, end_of_input, filter_by_charset);
   if (!result || !result->Evaluate(
                      dict_.get(), enable_user_dict ? user_dict_.get() : NULL)) {
     return nullptr;
@@ -445,14 +461,14 @@ bool ScriptTranslation::Evaluate(Dictionary* dict, UserDictionary* user_dict) {
   bool predict_word = translator_->enable_word_completion() &&
                       start_ + consumed == end_of_input_;
 
-  phrase_ =
-      dict->Lookup(syllable_graph, 0, &translator_->blacklist(), predict_word);
+  phrase_ = dict->Lookup(syllable_graph, 0, &translator_->blacklist(),
+                         predict_word, 0.0, filter_by_charset_);
   if (user_dict) {
     const size_t kUnlimitedDepth = 0;
     const size_t kNumSyllablesToPredictWord = 4;
-    user_phrase_ =
+    user_phrase_ = FilterByCharset(
         user_dict->Lookup(syllable_graph, 0, kUnlimitedDepth,
-                          predict_word ? kNumSyllablesToPredictWord : 0);
+                          predict_word ? kNumSyllablesToPredictWord : 0));
   }
   if (!phrase_ && !user_phrase_)
     return false;
@@ -501,7 +517,7 @@ bool ScriptTranslation::Next() {
       case kUninitialized:
         break;
       case kSentence:
-        sentence_.reset();
+        sentence_ = NextSentence();
         break;
       case kUserPhrase: {
         UserDictEntryIterator& uter(user_phrase_iter_->second);
@@ -619,9 +635,10 @@ bool ScriptTranslation::PrepareCandidate() {
                << "', code length: " << user_phrase_code_length;
     candidate_source_ = kUserPhrase;
     candidate_ =
-        New<Phrase>(translator_->language(),
-                    entry->IsPredictiveMatch() ? "completion" : "user_phrase",
-                    start_, start_ + user_phrase_code_length, entry);
+        NewPooled<Phrase>(
+            translator_->language(),
+            entry->IsPredictiveMatch() ? "completion" : "user_phrase", start_,
+            start_ + user_phrase_code_length, entry);
     candidate_->set_quality(std::exp(entry->weight) +
                             translator_->initial_quality() +
                             (entry->quality_len / full_code_length));
@@ -633,9 +650,9 @@ bool ScriptTranslation::PrepareCandidate() {
                << "', code length: " << phrase_code_length;
     candidate_source_ = kSysPhrase;
     candidate_ =
-        New<Phrase>(translator_->language(),
-                    entry->IsPredictiveMatch() ? "completion" : "phrase",
-                    start_, start_ + phrase_code_length, entry);
+        NewPooled<Phrase>(translator_->language(),
+                          entry->IsPredictiveMatch() ? "completion" : "phrase",
+                          start_, start_ + phrase_code_length, entry);
     candidate_->set_quality(std::exp(entry->weight) +
                             translator_->initial_quality() +
                             (entry->quality_len / full_code_length));
@@ -654,15 +671,13 @@ bool ScriptTranslation::CheckEmpty() {
 }
 
 template <class QueryResult>
-void ScriptTranslation::EnrollEntries(
-    map<int, DictEntryList>& entries_by_end_pos,
-    const an<QueryResult>& query_result) {
+void ScriptTranslation::EnrollEntries(WordLattice& words,
+                                      int start_pos,
+                                      const an<QueryResult>& query_result) {
   if (query_result) {
     for (auto& y : *query_result) {
-      DictEntryList& homophones = entries_by_end_pos[y.first];
-      while (homophones.size() < translator_->max_homophones() &&
-             !y.second.exhausted()) {
-        homophones.push_back(y.second.Peek());
+      while (!words.IsFull(start_pos, y.first) && !y.second.exhausted()) {
+        words.Add(start_pos, y.first, y.second.Peek());
         if (!y.second.Next())
           break;
       }
@@ -674,21 +689,31 @@ an<Sentence> ScriptTranslation::MakeSentence(Dictionary* dict,
                                              UserDictionary* user_dict) {
   const int kMaxSyllablesForUserPhraseQuery = 5;
   const auto& syllable_graph = syllabifier_->syllable_graph();
-  WordGraph graph;
+  WordLattice words(translator_->max_homophones());
   for (const auto& x : syllable_graph.edges) {
-    auto& same_start_pos = graph[x.first];
     if (user_dict) {
-      EnrollEntries(same_start_pos,
-                    user_dict->Lookup(syllable_graph, x.first,
-                                      kMaxSyllablesForUserPhraseQuery));
+      EnrollEntries(words, x.first,
+                    FilterByCharset(user_dict->Lookup(
+                        syllable_graph, x.first,
+                        kMaxSyllablesForUserPhraseQuery)));
     }
     // merge lookup results
-    EnrollEntries(same_start_pos, dict->Lookup(syllable_graph, x.first,
-                                               &translator_->blacklist()));
-  }
-  if (auto sentence =
-          poet_->MakeSentence(graph, syllable_graph.interpreted_length,
-                              translator_->GetPrecedingText(start_))) {
+    EnrollEntries(words, x.first,
+                  dict->Lookup(syllable_graph, x.first,
+                               &translator_->blacklist(), false, 0.0,
+                               filter_by_charset_));
+  }
+  words.Finish();
+  if (translator_->max_sentences() > 1) {
+    // the best sentence first, then the next best ones of the same lattice.
+    more_sentences_ = poet_->MakeSentences(
+        std::move(words), syllable_graph.interpreted_length,
+        translator_->GetPrecedingText(start_), start_);
+    return NextSentence();
+  }
+  if (auto sentence = poet_->MakeSentence(
+          std::move(words), syllable_graph.interpreted_length,
+          translator_->GetPrecedingText(start_))) {
     sentence->Offset(start_);
     sentence->set_syllabifier(syllabifier_);
     return sentence;
@@ -696,4 +721,31 @@ an<Sentence> ScriptTranslation::MakeSentence(Dictionary* dict,
   return nullptr;
 }
 
+// user phrases are tested as DictEntry objects, while table entries are
+// filtered by the dictionary before being made into ones.
+an<UserDictEntryCollector> ScriptTranslation::FilterByCharset(
+    an<UserDictEntryCollector> collector) {
+  if (!collector || !filter_by_charset_)
+    return collector;
+  for (auto it = collector->begin(); it != collector->end();) {
+    it->second.AddFilter(CharsetFilter::FilterDictEntry);
+    if (it->second.exhausted())
+      it = collector->erase(it);
+    else
+      ++it;
+  }
+  return collector->empty() ? nullptr : collector;
+}
+
+an<Sentence> ScriptTranslation::NextSentence() {
+  if (!more_sentences_ || more_sentences_->exhausted() ||
+      sentence_count_ >= translator_->max_sentences())
+    return nullptr;
+  auto sentence = As<Sentence>(more_sentences_->Peek());
+  more_sentences_->Next();
+  ++sentence_count_;
+  sentence->set_syllabifier(syllabifier_);
+  return sentence;
+}
+
 }  // namespace rime
@@ -32,6 +32,7 @@ class ScriptTranslator : public Translator,
 
   virtual an<Translation> Query(const string& input,
                                 const Segment& segment) override;
+  bool concurrent_query() const override { return !InSession(); }
   virtual bool Memorize(const CommitEntry& commit_entry) override;
   virtual bool ProcessSegmentOnCommit(CommitEntry& commit_entry,
                                       const Segment& seg) override;
@@ -50,6 +51,7 @@ class ScriptTranslator : public Translator,
   int spelling_hints() const { return spelling_hints_; }
   bool always_show_comments() const { return always_show_comments_; }
   bool enable_word_completion() const { return enable_word_completion_; }
+  bool enable_charset_filter() const { return enable_charset_filter_; }
   int max_word_length() const { return max_word_length_; }
   int core_word_length() const;
 
@@ -61,6 +63,7 @@ class ScriptTranslator : public Translator,
   bool always_show_comments_ = false;
   bool enable_correction_ = false;
   bool enable_word_completion_ = false;
+  bool enable_charset_filter_ = false;
   the<Corrector> corrector_;
   the<Poet> poet_;
   vector<an<Phrase>> queue_;
@@ -7,7 +7,6 @@
 #include <boost/algorithm/string.hpp>
 #include <stdint.h>
 #include <utf8.h>
-#include <utility>
 #include <rime/candidate.h>
 #include <rime/common.h>
 #include <rime/config.h>
@@ -16,6 +15,7 @@
 #include <rime/schema.h>
 #include <rime/service.h>
 #include <rime/translation.h>
+#include <rime/gear/conversion_cache.h>
 #include <rime/gear/simplifier.h>
 #include <opencc/Config.hpp>  // Place OpenCC #includes here to avoid VS2015 compilation errors
 #include <opencc/Converter.hpp>
@@ -31,8 +31,14 @@ namespace rime {
 
 class Opencc {
  public:
+  using Forms = ConversionCache::Forms;
+  // recent conversions kept for all simplifiers sharing the config.
+  static constexpr size_t kCacheCapacity = 4096;
+
   Opencc(const path& config_path)
-      : initialized_(false), config_path_(config_path) {}
+      : initialized_(false),
+        config_path_(config_path),
+        cache_(kCacheCapacity) {}
 
   void Initialize() {
     if (initialized_)
@@ -157,11 +163,31 @@ class Opencc {
     return *simplified != text;
   }
 
+  // converts the text as a word, or else as text; returns nullptr if it is
+  // left unchanged. results of recent conversions are reused.
+  an<const Forms> Convert(const string& text) {
+    an<const Forms> cached;
+    if (cache_.Find(text, &cached))
+      return cached;
+    an<Forms> forms = New<Forms>();
+    if (!ConvertWord(text, forms.get())) {
+      string converted;
+      if (ConvertText(text, &converted)) {
+        forms->push_back(std::move(converted));
+      } else {
+        forms.reset();
+      }
+    }
+    cache_.Insert(text, forms);
+    return forms;
+  }
+
  private:
   bool initialized_;
   path config_path_;
   opencc::ConverterPtr converter_;
   opencc::DictPtr dict_;
+  ConversionCache cache_;
 };
 
 // Simplifier
@@ -182,6 +208,7 @@ Simplifier::Simplifier(const Ticket& ticket, an<Opencc> opencc)
     config->GetBool(name_space_ + "/show_in_comment", &show_in_comment_);
     config->GetBool(name_space_ + "/inherit_comment", &inherit_comment_);
     comment_formatter_.Load(config->GetList(name_space_ + "/comment_format"));
+    comment_formatter_.EnableMemo();
     config->GetBool(name_space_ + "/random", &random_);
     config->GetString(name_space_ + "/option_name", &option_name_);
     if (auto types = config->GetList(name_space_ + "/excluded_types")) {
@@ -257,8 +284,8 @@ void Simplifier::PushBack(const an<Candidate>& original,
       }
     }
   }
-  result->push_back(New<ShadowCandidate>(original, "simplified", text, tips,
-                                         inherit_comment_));
+  result->push_back(NewPooled<ShadowCandidate>(original, "simplified", text,
+                                               tips, inherit_comment_));
 }
 
 bool Simplifier::Convert(const an<Candidate>& original,
@@ -274,22 +301,16 @@ bool Simplifier::Convert(const an<Candidate>& original,
       PushBack(original, result, simplified);
     }
   } else {  //! random_
-    vector<string> forms;
-    success = opencc_->ConvertWord(original->text(), &forms);
+    auto forms = opencc_->Convert(original->text());
+    success = bool(forms);
     if (success) {
-      for (size_t i = 0; i < forms.size(); ++i) {
-        if (forms[i] == original->text()) {
+      for (const auto& form : *forms) {
+        if (form == original->text()) {
           result->push_back(original);
         } else {
-          PushBack(original, result, forms[i]);
+          PushBack(original, result, form);
         }
       }
-    } else {
-      string simplified;
-      success = opencc_->ConvertText(original->text(), &simplified);
-      if (success) {
-        PushBack(original, result, simplified);
-      }
     }
   }
   return success;
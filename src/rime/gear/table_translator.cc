@@ -83,7 +83,7 @@ an<Candidate> TableTranslation::Peek() {
   auto type = incomplete       ? "completion"
               : is_user_phrase ? "user_table"
                                : "table";
-  auto phrase = New<Phrase>(language_, type, start_, end_, e);
+  auto phrase = NewPooled<Phrase>(language_, type, start_, end_, e);
   if (phrase) {
     phrase->set_comment(comment);
     phrase->set_preedit(preedit_);
@@ -112,6 +112,12 @@ bool TableTranslation::PreferUserPhrase() {
     return true;
 }
 
+// user phrases are tested as DictEntry objects, while table entries are
+// filtered by the dictionary before being made into ones.
+inline static void add_charset_filter(UserDictEntryIterator& uter) {
+  uter.AddFilter(CharsetFilter::FilterDictEntry);
+}
+
 // LazyTableTranslation
 
 class LazyTableTranslation : public TableTranslation {
@@ -124,7 +130,8 @@ class LazyTableTranslation : public TableTranslation {
                        size_t start,
                        size_t end,
                        const string& preedit,
-                       bool enable_user_dict);
+                       bool enable_user_dict,
+                       bool filter_by_charset);
   bool FetchUserPhrases(TableTranslator* translator);
   virtual bool FetchMoreUserPhrases();
   virtual bool FetchMoreTableEntries();
@@ -136,6 +143,7 @@ class LazyTableTranslation : public TableTranslation {
   size_t limit_;
   size_t user_dict_limit_;
   string user_dict_key_;
+  bool filter_by_charset_;
 };
 
 LazyTableTranslation::LazyTableTranslation(TableTranslator* translator,
@@ -143,7 +151,8 @@ LazyTableTranslation::LazyTableTranslation(TableTranslator* translator,
                                            size_t start,
                                            size_t end,
                                            const string& preedit,
-                                           bool enable_user_dict)
+                                           bool enable_user_dict,
+                                           bool filter_by_charset)
     : TableTranslation(translator,
                        translator->language(),
                        input,
@@ -154,7 +163,11 @@ LazyTableTranslation::LazyTableTranslation(TableTranslator* translator,
       blacklist_(&translator->blacklist()),
       user_dict_(enable_user_dict ? translator->user_dict() : NULL),
       limit_(kInitialSearchLimit),
-      user_dict_limit_(kInitialSearchLimit) {
+      user_dict_limit_(kInitialSearchLimit),
+      filter_by_charset_(filter_by_charset) {
+  if (filter_by_charset_) {
+    add_charset_filter(uter_);
+  }
   FetchUserPhrases(translator) || FetchMoreUserPhrases();
   FetchMoreTableEntries();
   CheckEmpty();
@@ -169,6 +182,8 @@ bool LazyTableTranslation::FetchUserPhrases(TableTranslator* translator) {
   if (encoder && encoder->loaded()) {
     encoder->LookupPhrases(&uter_, input_, false);
   }
+  // fetched entries are appended past the filtered ones.
+  uter_.SkipFilteredEntries();
   return !uter_.exhausted();
 }
 
@@ -183,6 +198,7 @@ bool LazyTableTranslation::FetchMoreUserPhrases() {
   } else {
     user_dict_limit_ *= kExpandingFactor;
   }
+  uter_.SkipFilteredEntries();
   return !uter_.exhausted();
 }
 
@@ -193,7 +209,8 @@ bool LazyTableTranslation::FetchMoreTableEntries() {
   DLOG(INFO) << "fetching more table entries: limit = " << limit_
              << ", count = " << previous_entry_count;
   DictEntryIterator more;
-  if (dict_->LookupWords(&more, input_, true, limit_, blacklist_) < limit_) {
+  if (dict_->LookupWords(&more, input_, true, limit_, blacklist_,
+                         filter_by_charset_) < limit_) {
     DLOG(INFO) << "all table entries obtained.";
     limit_ = 0;  // no more try
   } else {
@@ -257,15 +274,18 @@ an<Translation> TableTranslator::Query(const string& input,
   string code = input;
   boost::trim_right_if(code, boost::is_any_of(delimiters_));
 
+  bool filter_by_charset = enable_charset_filter_ &&
+                           !engine_->context()->get_option("extended_charset");
   an<Translation> translation;
   if (enable_completion_) {
-    translation = Cached<LazyTableTranslation>(this, code, segment.start,
-                                               segment.start + input.length(),
-                                               preedit, enable_user_dict);
+    translation = Cached<LazyTableTranslation>(
+        this, code, segment.start, segment.start + input.length(), preedit,
+        enable_user_dict, filter_by_charset);
   } else {
     DictEntryIterator iter;
     if (dict_ && dict_->loaded()) {
-      dict_->LookupWords(&iter, code, false, 0, &blacklist());
+      dict_->LookupWords(&iter, code, false, 0, &blacklist(),
+                         filter_by_charset);
     }
     UserDictEntryIterator uter;
     if (enable_user_dict) {
@@ -273,20 +293,15 @@ an<Translation> TableTranslator::Query(const string& input,
       if (encoder_ && encoder_->loaded()) {
         encoder_->LookupPhrases(&uter, code, false);
       }
+      if (filter_by_charset) {
+        add_charset_filter(uter);
+      }
     }
     if (!iter.exhausted() || !uter.exhausted())
       translation = Cached<TableTranslation>(
           this, language(), code, segment.start, segment.start + input.length(),
           preedit, std::move(iter), std::move(uter));
   }
-  if (translation) {
-    bool filter_by_charset =
-        enable_charset_filter_ &&
-        !engine_->context()->get_option("extended_charset");
-    if (filter_by_charset) {
-      translation = New<CharsetFilterTranslation>(translation);
-    }
-  }
   if (translation && translation->exhausted()) {
     translation.reset();  // discard futile translation
   }
@@ -390,12 +405,14 @@ class SentenceTranslation : public Translation {
                       DictEntryCollector&& collector,
                       UserDictEntryCollector&& ucollector,
                       const string& input,
-                      size_t start);
+                      size_t start,
+                      an<Translation> more_sentences = nullptr);
   virtual bool Next();
   virtual an<Candidate> Peek();
 
  protected:
   void PrepareSentence();
+  void NextSentence();
   bool CheckEmpty();
   bool PreferUserPhrase() const;
 
@@ -405,6 +422,10 @@ class SentenceTranslation : public Translation {
   UserDictEntryCollector user_phrase_collector_;
   string input_;
   size_t start_;
+  // yields the best sentence and the next best ones, if more than one is
+  // asked for.
+  an<Translation> more_sentences_;
+  int sentence_count_ = 0;
 };
 
 SentenceTranslation::SentenceTranslation(TableTranslator* translator,
@@ -412,20 +433,25 @@ SentenceTranslation::SentenceTranslation(TableTranslator* translator,
                                          DictEntryCollector&& collector,
                                          UserDictEntryCollector&& ucollector,
                                          const string& input,
-                                         size_t start)
+                                         size_t start,
+                                         an<Translation> more_sentences)
     : translator_(translator),
       sentence_(std::move(sentence)),
       collector_(std::move(collector)),
       user_phrase_collector_(std::move(ucollector)),
       input_(input),
-      start_(start) {
-  PrepareSentence();
+      start_(start),
+      more_sentences_(more_sentences) {
+  if (more_sentences_)
+    NextSentence();
+  else
+    PrepareSentence();
   CheckEmpty();
 }
 
 bool SentenceTranslation::Next() {
   if (sentence_) {
-    sentence_.reset();
+    NextSentence();
     return !CheckEmpty();
   }
   if (PreferUserPhrase()) {
@@ -460,9 +486,10 @@ an<Candidate> SentenceTranslation::Peek() {
     code_length = r->first;
     entry = r->second.Peek();
   }
-  auto result = New<Phrase>(translator_ ? translator_->language() : NULL,
-                            is_user_phrase ? "user_table" : "table", start_,
-                            start_ + code_length, entry);
+  auto result =
+      NewPooled<Phrase>(translator_ ? translator_->language() : NULL,
+                        is_user_phrase ? "user_table" : "table", start_,
+                        start_ + code_length, entry);
   if (translator_) {
     string preedit = input_.substr(0, code_length);
     translator_->preedit_formatter().Apply(&preedit);
@@ -471,6 +498,17 @@ an<Candidate> SentenceTranslation::Peek() {
   return result;
 }
 
+void SentenceTranslation::NextSentence() {
+  sentence_.reset();
+  if (!translator_ || !more_sentences_ || more_sentences_->exhausted() ||
+      sentence_count_ >= translator_->max_sentences())
+    return;
+  sentence_ = As<Sentence>(more_sentences_->Peek());
+  more_sentences_->Next();
+  ++sentence_count_;
+  PrepareSentence();
+}
+
 void SentenceTranslation::PrepareSentence() {
   if (!sentence_)
     return;
@@ -527,17 +565,67 @@ inline static size_t consume_trailing_delimiters(size_t pos,
   return pos;
 }
 
-template <class Iter>
-inline static void collect_entries(DictEntryList& entries,
-                                   Iter& iter,
-                                   int max_entries) {
-  if (entries.size() < max_entries && !iter.exhausted()) {
-    entries.push_back(iter.Peek());
-    // alters iter if collecting more than 1 entries
-    while (entries.size() < max_entries && iter.Next()) {
-      entries.push_back(iter.Peek());
+// looks up `key` once for both the memo of at most `max_entries` entries, and
+// if given, the memo of all entries in an unconsumed iterator.
+template <class Iter, class LookupFunc>
+static const TableLookupMemo::Words& memoized_lookup(
+    hash_map<string, TableLookupMemo::Words>& memo,
+    const string& key,
+    size_t max_entries,
+    LookupFunc lookup,
+    hash_map<string, Iter>* full_memo = nullptr) {
+  bool found = memo.find(key) != memo.end();
+  if (found && (!full_memo || full_memo->find(key) != full_memo->end()))
+    return memo[key];
+  Iter iter;
+  string resume_key;
+  lookup(&iter, &resume_key);
+  if (full_memo) {
+    (*full_memo)[key] = iter;
+  }
+  auto& words = memo[key];
+  if (!found) {
+    words.resume_key = std::move(resume_key);
+    for (; !iter.exhausted() && words.entries.size() < max_entries;
+         iter.Next()) {
+      words.entries.push_back(iter.Peek());
     }
   }
+  return words;
+}
+
+inline static void collect_entries(WordLattice& words,
+                                   int start_pos,
+                                   int end_pos,
+                                   const DictEntryList& entries) {
+  for (const auto& entry : entries) {
+    if (!words.Add(start_pos, end_pos, entry))
+      break;
+  }
+}
+
+void TableTranslator::ValidateLookupMemo(const string& input,
+                                         size_t start,
+                                         bool filter_by_charset) {
+  auto& memo = lookup_memo_;
+  size_t user_dict_revision = user_dict_ ? user_dict_->revision() : 0;
+  bool valid = memo.start == start &&
+               memo.filter_by_charset == filter_by_charset &&
+               memo.user_dict_revision == user_dict_revision &&
+               (boost::starts_with(input, memo.input) ||
+                boost::starts_with(memo.input, input));
+  if (!valid) {
+    memo.user_words.clear();
+    memo.unity_phrases.clear();
+    memo.table_words.clear();
+    memo.user_prefix_words.clear();
+    memo.unity_prefix_phrases.clear();
+    memo.table_prefix_words.clear();
+    memo.start = start;
+    memo.filter_by_charset = filter_by_charset;
+    memo.user_dict_revision = user_dict_revision;
+  }
+  memo.input = input;
 }
 
 an<Translation> TableTranslator::MakeSentence(const string& input,
@@ -545,9 +633,11 @@ an<Translation> TableTranslator::MakeSentence(const string& input,
                                               bool include_prefix_phrases) {
   bool filter_by_charset = enable_charset_filter_ &&
                            !engine_->context()->get_option("extended_charset");
+  ValidateLookupMemo(input, start, filter_by_charset);
+  size_t max_entries = max_homographs_;
   DictEntryCollector collector;
   UserDictEntryCollector user_phrase_collector;
-  WordGraph graph;
+  WordLattice words(max_homographs_);
   hash_set<int> vertices = {0};
   for (size_t start_pos = 0; start_pos < input.length(); ++start_pos) {
     // find next reachable vertex in word graph
@@ -555,40 +645,37 @@ an<Translation> TableTranslator::MakeSentence(const string& input,
       continue;
     string active_input = input.substr(start_pos);
     string active_key = active_input + ' ';
-    auto& same_start_pos = graph[start_pos];
     // lookup dictionaries
     if (user_dict_ && user_dict_->loaded()) {
       for (size_t len = 1; len <= active_input.length(); ++len) {
         size_t consumed_length =
             consume_trailing_delimiters(len, active_input, delimiters_);
         size_t end_pos = start_pos + consumed_length;
-        auto& homographs = same_start_pos[end_pos];
-        if (homographs.size() >= max_homographs_)
+        if (words.IsFull(start_pos, end_pos))
           continue;
         DLOG(INFO) << "active input: " << active_input << "[0, " << len << ")";
-        UserDictEntryIterator uter;
-        string resume_key;
         string key = active_input.substr(0, len);
-        user_dict_->LookupWords(&uter, key, false, 0, &resume_key);
-        if (filter_by_charset) {
-          uter.AddFilter(CharsetFilter::FilterDictEntry);
-        }
-        if (!uter.exhausted()) {
+        bool prefix = include_prefix_phrases && start_pos == 0;
+        const auto& found = memoized_lookup<UserDictEntryIterator>(
+            lookup_memo_.user_words, key, max_entries,
+            [&](UserDictEntryIterator* uter, string* resume_key) {
+              user_dict_->LookupWords(uter, key, false, 0, resume_key);
+              if (filter_by_charset)
+                add_charset_filter(*uter);
+            },
+            prefix ? &lookup_memo_.user_prefix_words : nullptr);
+        if (!found.entries.empty()) {
           vertices.insert(end_pos);
-          if (start_pos == 0 && max_homographs_ > 1) {
-            UserDictEntryIterator uter_copy(uter);
-            collect_entries(homographs, uter_copy, max_homographs_);
-          } else {
-            collect_entries(homographs, uter, max_homographs_);
-          }
-          if (include_prefix_phrases && start_pos == 0) {
+          collect_entries(words, start_pos, end_pos, found.entries);
+          if (prefix) {
             // also provide words for manual composition
-            // uter must not be consumed
-            user_phrase_collector[consumed_length] = std::move(uter);
+            user_phrase_collector[consumed_length] =
+                lookup_memo_.user_prefix_words[key];
             DLOG(INFO) << "user phrase[" << consumed_length << "] cached: "
                        << user_phrase_collector[consumed_length].cache_size();
           }
         }
+        const string& resume_key = found.resume_key;
         if (resume_key > active_key &&
             !boost::starts_with(resume_key, active_key))
           break;
@@ -600,33 +687,31 @@ an<Translation> TableTranslator::MakeSentence(const string& input,
         size_t consumed_length =
             consume_trailing_delimiters(len, active_input, delimiters_);
         size_t end_pos = start_pos + consumed_length;
-        auto& homographs = same_start_pos[end_pos];
-        if (!homographs.empty())
+        if (words.CountEntries(start_pos, end_pos) > 0)
           continue;
         DLOG(INFO) << "active input: " << active_input << "[0, " << len << ")";
-        UserDictEntryIterator uter;
-        string resume_key;
         string key = active_input.substr(0, len);
-        encoder_->LookupPhrases(&uter, key, false, 0, &resume_key);
-        if (filter_by_charset) {
-          uter.AddFilter(CharsetFilter::FilterDictEntry);
-        }
-        if (!uter.exhausted()) {
+        bool prefix = include_prefix_phrases && start_pos == 0;
+        const auto& found = memoized_lookup<UserDictEntryIterator>(
+            lookup_memo_.unity_phrases, key, max_entries,
+            [&](UserDictEntryIterator* uter, string* resume_key) {
+              encoder_->LookupPhrases(uter, key, false, 0, resume_key);
+              if (filter_by_charset)
+                add_charset_filter(*uter);
+            },
+            prefix ? &lookup_memo_.unity_prefix_phrases : nullptr);
+        if (!found.entries.empty()) {
           vertices.insert(end_pos);
-          if (start_pos == 0 && max_homographs_ > 1) {
-            UserDictEntryIterator uter_copy(uter);
-            collect_entries(homographs, uter_copy, max_homographs_);
-          } else {
-            collect_entries(homographs, uter, max_homographs_);
-          }
-          if (include_prefix_phrases && start_pos == 0) {
+          collect_entries(words, start_pos, end_pos, found.entries);
+          if (prefix) {
             // also provide words for manual composition
-            // uter must not be consumed
-            user_phrase_collector[consumed_length] = std::move(uter);
+            user_phrase_collector[consumed_length] =
+                lookup_memo_.unity_prefix_phrases[key];
             DLOG(INFO) << "unity phrase[" << consumed_length << "] cached: "
                        << user_phrase_collector[consumed_length].cache_size();
           }
         }
+        const string& resume_key = found.resume_key;
         if (resume_key > active_key &&
             !boost::starts_with(resume_key, active_key))
           break;
@@ -643,27 +728,23 @@ an<Translation> TableTranslator::MakeSentence(const string& input,
         size_t consumed_length =
             consume_trailing_delimiters(m.length, active_input, delimiters_);
         size_t end_pos = start_pos + consumed_length;
-        auto& homographs = same_start_pos[end_pos];
-        if (homographs.size() >= max_homographs_)
+        if (words.IsFull(start_pos, end_pos))
           continue;
-        DictEntryIterator iter;
-        dict_->LookupWords(&iter, active_input.substr(0, m.length), false, 0,
-                           &blacklist());
-        if (filter_by_charset) {
-          iter.AddFilter(CharsetFilter::FilterDictEntry);
-        }
-        if (!iter.exhausted()) {
+        string key = active_input.substr(0, m.length);
+        bool prefix = include_prefix_phrases && start_pos == 0;
+        const auto& found = memoized_lookup<DictEntryIterator>(
+            lookup_memo_.table_words, key, max_entries,
+            [&](DictEntryIterator* iter, string* /* resume_key */) {
+              dict_->LookupWords(iter, key, false, 0, &blacklist(),
+                                 filter_by_charset);
+            },
+            prefix ? &lookup_memo_.table_prefix_words : nullptr);
+        if (!found.entries.empty()) {
           vertices.insert(end_pos);
-          if (start_pos == 0 && max_homographs_ - homographs.size() > 1) {
-            DictEntryIterator iter_copy = iter;
-            collect_entries(homographs, iter_copy, max_homographs_);
-          } else {
-            collect_entries(homographs, iter, max_homographs_);
-          }
-          if (include_prefix_phrases && start_pos == 0) {
+          collect_entries(words, start_pos, end_pos, found.entries);
+          if (prefix) {
             // also provide words for manual composition
-            // iter must not be consumed
-            collector[consumed_length] = std::move(iter);
+            collector[consumed_length] = lookup_memo_.table_prefix_words[key];
             DLOG(INFO) << "table[" << consumed_length
                        << "]: " << collector[consumed_length].entry_count();
           }
@@ -671,15 +752,22 @@ an<Translation> TableTranslator::MakeSentence(const string& input,
       }
     }
   }
-  if (auto sentence =
-          poet_->MakeSentence(graph, input.length(), GetPrecedingText(start))) {
-    auto result = Cached<SentenceTranslation>(
+  words.Finish();
+  if (max_sentences_ > 1) {
+    // the other sentences come of the same lattice, after the best one.
+    auto sentences = poet_->MakeSentences(std::move(words), input.length(),
+                                          GetPrecedingText(start));
+    if (!sentences || sentences->exhausted())
+      return nullptr;
+    return Cached<SentenceTranslation>(
+        this, nullptr, std::move(collector), std::move(user_phrase_collector),
+        input, start, sentences);
+  }
+  if (auto sentence = poet_->MakeSentence(std::move(words), input.length(),
+                                          GetPrecedingText(start))) {
+    return Cached<SentenceTranslation>(
         this, std::move(sentence), std::move(collector),
         std::move(user_phrase_collector), input, start);
-    if (result && filter_by_charset) {
-      return New<CharsetFilterTranslation>(result);
-    }
-    return result;
   }
   return nullptr;
 }
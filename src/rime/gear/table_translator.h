@@ -22,6 +22,29 @@ namespace rime {
 class Poet;
 class UnityTableEncoder;
 
+// Dictionary lookups of codes in the input of a segment, kept across
+// keystrokes for making sentences as long as the segment grows or shrinks
+// at the end.
+struct TableLookupMemo {
+  struct Words {
+    // at most max_homographs entries.
+    DictEntryList entries;
+    string resume_key;
+  };
+  size_t start = 0;
+  string input;
+  bool filter_by_charset = false;
+  size_t user_dict_revision = 0;
+  hash_map<string, Words> user_words;
+  hash_map<string, Words> unity_phrases;
+  hash_map<string, Words> table_words;
+  // all entries of codes at the start of the input, unconsumed, to be copied
+  // for composing sentences manually.
+  hash_map<string, UserDictEntryIterator> user_prefix_words;
+  hash_map<string, UserDictEntryIterator> unity_prefix_phrases;
+  hash_map<string, DictEntryIterator> table_prefix_words;
+};
+
 class TableTranslator : public Translator,
                         public Memory,
                         public TranslatorOptions {
@@ -29,6 +52,7 @@ class TableTranslator : public Translator,
   TableTranslator(const Ticket& ticket);
 
   virtual an<Translation> Query(const string& input, const Segment& segment);
+  bool concurrent_query() const override { return !InSession(); }
   virtual bool Memorize(const CommitEntry& commit_entry);
 
   an<Translation> MakeSentence(const string& input,
@@ -38,6 +62,10 @@ class TableTranslator : public Translator,
   UnityTableEncoder* encoder() const { return encoder_.get(); }
 
  protected:
+  void ValidateLookupMemo(const string& input,
+                          size_t start,
+                          bool filter_by_charset);
+
   bool enable_charset_filter_ = false;
   bool enable_encoder_ = false;
   bool enable_sentence_ = true;
@@ -47,6 +75,7 @@ class TableTranslator : public Translator,
   int max_homographs_ = 1;
   the<Poet> poet_;
   the<UnityTableEncoder> encoder_;
+  TableLookupMemo lookup_memo_;
 };
 
 class TableTranslation : public Translation {
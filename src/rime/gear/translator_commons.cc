@@ -125,10 +125,14 @@ TranslatorOptions::TranslatorOptions(const Ticket& ticket) {
     config->GetBool(ticket.name_space + "/strict_spelling", &strict_spelling_);
     config->GetDouble(ticket.name_space + "/initial_quality",
                       &initial_quality_);
+    config->GetInt(ticket.name_space + "/max_sentences", &max_sentences_);
     preedit_formatter_.Load(
         config->GetList(ticket.name_space + "/preedit_format"));
     comment_formatter_.Load(
         config->GetList(ticket.name_space + "/comment_format"));
+    // the same codes are formatted for every keystroke.
+    preedit_formatter_.EnableMemo();
+    comment_formatter_.EnableMemo();
     user_dict_disabling_patterns_.Load(
         config->GetList(ticket.name_space + "/disable_user_dict_for_patterns"));
     string tag;
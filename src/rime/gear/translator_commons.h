@@ -114,12 +114,12 @@ class Phrase : public Candidate {
 class Sentence : public Phrase {
  public:
   Sentence(const Language* language)
-      : Phrase(language, "sentence", 0, 0, New<DictEntry>()) {}
+      : Phrase(language, "sentence", 0, 0, NewPooled<DictEntry>()) {}
   Sentence(const Sentence& other)
       : Phrase(other),
         components_(other.components_),
         word_lengths_(other.word_lengths_) {
-    entry_ = New<DictEntry>(other.entry());
+    entry_ = NewPooled<DictEntry>(other.entry());
   }
   void Extend(const DictEntry& another, size_t end_pos, double new_weight);
   void Offset(size_t offset);
@@ -165,6 +165,9 @@ class TranslatorOptions {
   void set_strict_spelling(bool is_strict) { strict_spelling_ = is_strict; }
   double initial_quality() const { return initial_quality_; }
   void set_initial_quality(double quality) { initial_quality_ = quality; }
+  // number of sentences made of the same word lattice, the best one first.
+  int max_sentences() const { return max_sentences_; }
+  void set_max_sentences(int max_sentences) { max_sentences_ = max_sentences; }
   Projection& preedit_formatter() { return preedit_formatter_; }
   Projection& comment_formatter() { return comment_formatter_; }
   const hash_set<string>& blacklist() { return blacklist_; }
@@ -176,6 +179,7 @@ class TranslatorOptions {
   bool enable_completion_ = true;
   bool strict_spelling_ = false;
   double initial_quality_ = 0.;
+  int max_sentences_ = 1;
   Projection preedit_formatter_;
   Projection comment_formatter_;
   Patterns user_dict_disabling_patterns_;
@@ -21,31 +21,38 @@ class UniquifiedTranslation : public CacheTranslation {
 
  protected:
   bool Uniquify();
+  CandidateList::iterator FindTextMatch(const an<Candidate>& target);
 
   an<Translation> translation_;
   CandidateList* candidates_;
+  // position of the first candidate of each text in candidates_, which only
+  // grows at the end; indexed up to num_indexed_candidates_.
+  hash_map<string, size_t> text_index_;
+  size_t num_indexed_candidates_ = 0;
 };
 
 bool UniquifiedTranslation::Next() {
   return CacheTranslation::Next() && Uniquify();
 }
 
-static CandidateList::iterator find_text_match(const an<Candidate>& target,
-                                               CandidateList::iterator begin,
-                                               CandidateList::iterator end) {
-  for (auto iter = begin; iter != end; ++iter) {
-    if ((*iter)->text() == target->text()) {
-      return iter;
-    }
+CandidateList::iterator UniquifiedTranslation::FindTextMatch(
+    const an<Candidate>& target) {
+  for (; num_indexed_candidates_ < candidates_->size();
+       ++num_indexed_candidates_) {
+    const auto& cand = (*candidates_)[num_indexed_candidates_];
+    text_index_.emplace(cand->text(), num_indexed_candidates_);
+  }
+  auto found = text_index_.find(target->text());
+  if (found == text_index_.end()) {
+    return candidates_->end();
   }
-  return end;
+  return candidates_->begin() + found->second;
 }
 
 bool UniquifiedTranslation::Uniquify() {
   while (!exhausted()) {
     auto next = Peek();
-    CandidateList::iterator previous =
-        find_text_match(next, candidates_->begin(), candidates_->end());
+    CandidateList::iterator previous = FindTextMatch(next);
     if (previous == candidates_->end()) {
       // Encountered a unique candidate.
       return true;
@@ -53,7 +60,7 @@ bool UniquifiedTranslation::Uniquify() {
     auto uniquified = As<UniquifiedCandidate>(*previous);
     if (!uniquified) {
       *previous = uniquified =
-          New<UniquifiedCandidate>(*previous, "uniquified");
+          NewPooled<UniquifiedCandidate>(*previous, "uniquified");
     }
     uniquified->Append(next);
     CacheTranslation::Next();
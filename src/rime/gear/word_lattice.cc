@@ -0,0 +1,97 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <rime/gear/word_lattice.h>
+
+namespace rime {
+
+bool WordLattice::Add(int start_pos, int end_pos, an<DictEntry> entry) {
+  if (start_pos != pending_start_pos_) {
+    FlushPendingEntries();
+    if (!edges_.empty() && start_pos < edges_.back().start_pos) {
+      LOG(ERROR) << "words added out of order at position " << start_pos;
+      return false;
+    }
+    pending_start_pos_ = start_pos;
+  }
+  auto count = std::find_if(
+      pending_counts_.begin(), pending_counts_.end(),
+      [end_pos](const pair<int, size_t>& x) { return x.first == end_pos; });
+  if (count == pending_counts_.end()) {
+    pending_counts_.emplace_back(end_pos, 0);
+    count = pending_counts_.end() - 1;
+  }
+  if (count->second >= max_entries_per_edge_)
+    return false;
+  ++count->second;
+  pending_entries_.emplace_back(end_pos, std::move(entry));
+  return true;
+}
+
+size_t WordLattice::CountEntries(int start_pos, int end_pos) const {
+  if (start_pos == pending_start_pos_) {
+    for (const auto& count : pending_counts_) {
+      if (count.first == end_pos)
+        return count.second;
+    }
+    return 0;
+  }
+  const Edge* edge = FindEdge(start_pos, end_pos);
+  return edge ? edge->size() : 0;
+}
+
+void WordLattice::Finish() {
+  FlushPendingEntries();
+  pending_start_pos_ = -1;
+}
+
+void WordLattice::FlushPendingEntries() {
+  if (pending_entries_.empty())
+    return;
+  std::stable_sort(
+      pending_entries_.begin(), pending_entries_.end(),
+      [](const pair<int, an<DictEntry>>& a, const pair<int, an<DictEntry>>& b) {
+        return a.first < b.first;
+      });
+  for (auto& x : pending_entries_) {
+    if (edges_.empty() || edges_.back().start_pos != pending_start_pos_ ||
+        edges_.back().end_pos != x.first) {
+      edges_.push_back(
+          {pending_start_pos_, x.first, entries_.size(), entries_.size()});
+      num_positions_ = (std::max)(num_positions_, size_t(x.first) + 1);
+    }
+    entries_.push_back(std::move(x.second));
+    ++edges_.back().end;
+  }
+  pending_entries_.clear();
+  pending_counts_.clear();
+}
+
+pair<WordLattice::EdgeIterator, WordLattice::EdgeIterator>
+WordLattice::EdgesFrom(int start_pos) const {
+  return std::equal_range(edges_.begin(), edges_.end(),
+                          Edge{start_pos, 0, 0, 0},
+                          [](const Edge& a, const Edge& b) {
+                            return a.start_pos < b.start_pos;
+                          });
+}
+
+const WordLattice::Edge* WordLattice::FindEdge(int start_pos,
+                                               int end_pos) const {
+  auto edge = std::lower_bound(edges_.begin(), edges_.end(),
+                               Edge{start_pos, end_pos, 0, 0},
+                               [](const Edge& a, const Edge& b) {
+                                 return a.start_pos < b.start_pos ||
+                                        (a.start_pos == b.start_pos &&
+                                         a.end_pos < b.end_pos);
+                               });
+  return edge != edges_.end() && edge->start_pos == start_pos &&
+                 edge->end_pos == end_pos
+             ? &*edge
+             : nullptr;
+}
+
+}  // namespace rime
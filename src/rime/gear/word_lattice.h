@@ -0,0 +1,72 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_WORD_LATTICE_H_
+#define RIME_WORD_LATTICE_H_
+
+#include <rime/common.h>
+#include <rime/dict/vocabulary.h>
+
+namespace rime {
+
+// Words found in the input to make sentences of, grouped in edges by their
+// start and end positions. Entries of all edges are kept in a single array,
+// edge after edge, and edges are sorted by start then end position.
+//
+// Words are added by increasing start position, and the lattice is finished
+// before it is read. Entries of an edge keep the order they are added in,
+// and those beyond `max_entries_per_edge` are dropped.
+class WordLattice {
+ public:
+  struct Edge {
+    int start_pos;
+    int end_pos;
+    // entries [begin, end) of the lattice.
+    size_t begin;
+    size_t end;
+
+    size_t size() const { return end - begin; }
+  };
+  using EdgeIterator = vector<Edge>::const_iterator;
+
+  explicit WordLattice(size_t max_entries_per_edge = size_t(-1))
+      : max_entries_per_edge_(max_entries_per_edge) {}
+
+  // returns false if the entry is dropped as the edge is full.
+  bool Add(int start_pos, int end_pos, an<DictEntry> entry);
+  size_t CountEntries(int start_pos, int end_pos) const;
+  bool IsFull(int start_pos, int end_pos) const {
+    return CountEntries(start_pos, end_pos) >= max_entries_per_edge_;
+  }
+  void Finish();
+
+  bool empty() const { return edges_.empty(); }
+  const vector<Edge>& edges() const { return edges_; }
+  // edges starting at `start_pos`, by end position.
+  pair<EdgeIterator, EdgeIterator> EdgesFrom(int start_pos) const;
+  const Edge* FindEdge(int start_pos, int end_pos) const;
+  // one past the last position of any edge.
+  size_t num_positions() const { return num_positions_; }
+
+  size_t num_entries() const { return entries_.size(); }
+  const an<DictEntry>& entry(size_t index) const { return entries_[index]; }
+  an<DictEntry>& entry(size_t index) { return entries_[index]; }
+
+ private:
+  void FlushPendingEntries();
+
+  size_t max_entries_per_edge_;
+  vector<an<DictEntry>> entries_;
+  vector<Edge> edges_;
+  size_t num_positions_ = 0;
+  // words added at the current start position, to be sorted by end position.
+  int pending_start_pos_ = -1;
+  vector<pair<int, an<DictEntry>>> pending_entries_;
+  vector<pair<int, size_t>> pending_counts_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_WORD_LATTICE_H_
@@ -49,14 +49,15 @@ bool DetectModifications::Run(Deployer* deployer) {
       last_modified = (std::max)(last_modified,
                                  filesystem::to_time_t(fs::last_write_time(p)));
       if (fs::is_directory(p)) {
+        // directory entries cache file status where the platform allows.
         for (fs::directory_iterator iter(p), end; iter != end; ++iter) {
-          path entry(iter->path());
-          if (fs::is_regular_file(fs::canonical(entry)) &&
-              entry.extension().u8string() == ".yaml" &&
-              entry.filename().u8string() != "user.yaml") {
+          const path& entry(iter->path());
+          if (entry.extension().u8string() == ".yaml" &&
+              entry.filename().u8string() != "user.yaml" &&
+              iter->is_regular_file()) {
             last_modified =
                 (std::max)(last_modified,
-                           filesystem::to_time_t(fs::last_write_time(entry)));
+                           filesystem::to_time_t(iter->last_write_time()));
           }
         }
       }
@@ -372,7 +373,9 @@ bool SchemaUpdate::Run(Deployer* deployer) {
       Service::instance().CreateDeployedResourceResolver(
           {"compiled_schema", "", ".schema.yaml"}));
   auto compiled_schema = resolver->ResolvePath(schema_id);
-  if (!dict_compiler.Compile(compiled_schema)) {
+  bool success = dict_compiler.Compile(compiled_schema);
+  deployer->SaveFileManifest();
+  if (!success) {
     LOG(ERROR) << "dictionary '" << dict_name << "' failed to compile.";
     return false;
   }
@@ -24,12 +24,27 @@ void Menu::AddFilter(Filter* filter) {
 }
 
 size_t Menu::Prepare(size_t requested) {
+  return Prepare(requested, Budget());
+}
+
+size_t Menu::Prepare(size_t requested, const Budget& budget) {
   DLOG(INFO) << "preparing " << requested << " candidates.";
+  using clock = std::chrono::steady_clock;
+  auto deadline = clock::now() + budget.max_time;
+  size_t pulled = 0;
   while (candidates_.size() < requested && !result_->exhausted()) {
+    if (pulled > 0 &&
+        ((budget.max_candidates && pulled >= budget.max_candidates) ||
+         (budget.max_time.count() && clock::now() >= deadline))) {
+      DLOG(INFO) << "out of budget after pulling " << pulled
+                 << " candidates.";
+      break;
+    }
     if (auto cand = result_->Peek()) {
       candidates_.push_back(cand);
     }
     result_->Next();
+    ++pulled;
   }
   return candidates_.size();
 }
@@ -68,4 +83,8 @@ bool Menu::empty() const {
   return candidates_.empty() && result_->exhausted();
 }
 
+bool Menu::exhausted() const {
+  return result_->exhausted();
+}
+
 }  // namespace rime
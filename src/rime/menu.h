@@ -7,6 +7,7 @@
 #ifndef RIME_MENU_H_
 #define RIME_MENU_H_
 
+#include <chrono>
 #include <rime_api.h>
 #include <rime/candidate.h>
 #include <rime/common.h>
@@ -26,12 +27,23 @@ class Translation;
 
 class Menu {
  public:
+  // limits the work of a call to prepare candidates; zero for no limit.
+  struct Budget {
+    // candidates pulled through translations and filters, including those
+    // filtered out.
+    size_t max_candidates = 0;
+    std::chrono::microseconds max_time{0};
+  };
+
   RIME_DLL Menu();
 
   RIME_DLL void AddTranslation(an<Translation> translation);
   void AddFilter(Filter* filter);
 
   RIME_DLL size_t Prepare(size_t candidate_count);
+  // prepares candidates as above, but returns early with fewer candidates
+  // once the budget is spent. the next call resumes where this one stopped.
+  RIME_DLL size_t Prepare(size_t candidate_count, const Budget& budget);
   RIME_DLL Page* CreatePage(size_t page_size, size_t page_no);
   an<Candidate> GetCandidateAt(size_t index);
 
@@ -40,6 +52,8 @@ class Menu {
   size_t candidate_count() const { return candidates_.size(); }
 
   bool empty() const;
+  // no more candidates can be prepared.
+  RIME_DLL bool exhausted() const;
 
  private:
   an<MergedTranslation> merged_;
@@ -0,0 +1,139 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <filesystem>
+#include <rime/config.h>
+#include <rime/retention_cache.h>
+
+namespace rime {
+
+void RetentionCache::RecordLookup(const path& file_path, long use_count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (use_count == 0) {
+    ++stats_.misses;
+  } else if (use_count == 2 && index_.count(file_path)) {
+    // referenced by the caller and the cache only.
+    ++stats_.hits;
+  }
+}
+
+void RetentionCache::Retain(an<void> resource, const path& file_path) {
+  if (!resource)
+    return;
+  EntryList evicted;  // destroyed after the lock is released
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!settings_loaded_) {
+    LoadSettings();
+  }
+  auto found = index_.find(file_path);
+  if (found != index_.end()) {
+    auto it = found->second;
+    it->resource = std::move(resource);
+    entries_.splice(entries_.begin(), entries_, it);
+    return;
+  }
+  size_t size = EstimateSize(file_path);
+  if (size == 0 || size > budget_) {
+    return;
+  }
+  entries_.push_front({file_path, std::move(resource), size});
+  index_[file_path] = entries_.begin();
+  stats_.retained_size += size;
+  ++stats_.retained_count;
+  EvictOverBudget(&evicted);
+}
+
+void RetentionCache::Release(const path& file_path) {
+  EntryList released;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(file_path);
+  if (found == index_.end())
+    return;
+  auto it = found->second;
+  stats_.retained_size -= it->size;
+  --stats_.retained_count;
+  released.splice(released.end(), entries_, it);
+  index_.erase(found);
+}
+
+void RetentionCache::Clear() {
+  EntryList released;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stats_.hits || stats_.misses) {
+    LOG(INFO) << "retention cache: " << stats_.hits << " hits, "
+              << stats_.misses << " misses, " << stats_.evictions
+              << " evictions; releasing " << stats_.retained_count
+              << " entries (" << stats_.retained_size << " bytes).";
+  }
+  released.swap(entries_);
+  index_.clear();
+  stats_.retained_count = 0;
+  stats_.retained_size = 0;
+}
+
+RetentionCache::Stats RetentionCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+size_t RetentionCache::budget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+void RetentionCache::set_budget(size_t budget) {
+  EntryList evicted;
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_ = budget;
+  settings_loaded_ = true;
+  EvictOverBudget(&evicted);
+}
+
+size_t RetentionCache::EstimateSize(const path& file_path) {
+  std::error_code ec;
+  if (!std::filesystem::is_directory(file_path, ec)) {
+    auto size = std::filesystem::file_size(file_path, ec);
+    return ec ? 0 : size_t(size);
+  }
+  // a db directory; add up its files.
+  size_t total = 0;
+  for (std::filesystem::recursive_directory_iterator it(file_path, ec), end;
+       !ec && it != end; it.increment(ec)) {
+    if (it->is_regular_file(ec)) {
+      auto size = it->file_size(ec);
+      if (!ec)
+        total += size_t(size);
+    }
+  }
+  return total;
+}
+
+void RetentionCache::LoadSettings() {
+  settings_loaded_ = true;
+  auto* component = Config::Require("config");
+  if (!component)
+    return;
+  the<Config> config(component->Create("default"));
+  int budget_mb = 0;
+  if (config &&
+      config->GetInt("dictionary_retention/memory_budget", &budget_mb)) {
+    budget_ = budget_mb > 0 ? size_t(budget_mb) << 20 : 0;
+  }
+  DLOG(INFO) << "retention cache budget: " << budget_ << " bytes.";
+}
+
+void RetentionCache::EvictOverBudget(EntryList* evicted) {
+  while (!entries_.empty() && stats_.retained_size > budget_) {
+    auto it = std::prev(entries_.end());
+    DLOG(INFO) << "evicting " << it->file_path << " from retention cache.";
+    stats_.retained_size -= it->size;
+    --stats_.retained_count;
+    ++stats_.evictions;
+    index_.erase(it->file_path);
+    evicted->splice(evicted->end(), entries_, it);
+  }
+}
+
+}  // namespace rime
@@ -0,0 +1,75 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_RETENTION_CACHE_H_
+#define RIME_RETENTION_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// Keeps strong references to recently used resources (dictionary tables,
+// prisms, user dbs) after their last user has gone, so that the next session
+// opening the same resource does not have to load it all over again.
+// Entries are evicted in LRU order once their total size on disk exceeds the
+// memory budget, configured in default.yaml with
+// `dictionary_retention/memory_budget` (in MiB; 0 disables retention).
+class RIME_DLL RetentionCache {
+ public:
+  static constexpr size_t kDefaultBudget = 64 << 20;  // bytes
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t retained_count = 0;
+    size_t retained_size = 0;
+  };
+
+  // counts a lookup of the resource loaded from `file_path`, given the
+  // use_count() of the caller's reference to it, or 0 if it was not alive.
+  // it is a hit if the cache alone kept it alive, a miss if it is to be
+  // loaded again; sharing a resource in use elsewhere counts as neither.
+  void RecordLookup(const path& file_path, long use_count);
+  // retains `resource` loaded from `file_path` and marks it most recently
+  // used. the size of the file or directory counts against the memory budget;
+  // empty or missing files, eg. of resources yet to be built, aren't retained.
+  void Retain(an<void> resource, const path& file_path);
+  // drops the resource loaded from `file_path`, if any.
+  void Release(const path& file_path);
+  // drops all entries, eg. to let go of files to be rebuilt or synced.
+  void Clear();
+
+  Stats stats() const;
+  size_t budget() const;
+  void set_budget(size_t budget);
+
+  static size_t EstimateSize(const path& file_path);
+
+ private:
+  struct Entry {
+    path file_path;
+    an<void> resource;
+    size_t size;
+  };
+  using EntryList = std::list<Entry>;
+
+  void LoadSettings();
+  void EvictOverBudget(EntryList* evicted);
+
+  mutable std::mutex mutex_;
+  EntryList entries_;  // most recently used first
+  map<path, EntryList::iterator> index_;
+  size_t budget_ = kDefaultBudget;
+  bool settings_loaded_ = false;
+  Stats stats_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_RETENTION_CACHE_H_
@@ -4,11 +4,13 @@
 //
 // 2011-08-08 GONG Chen <chen.sst@gmail.com>
 //
+#include <rime/block_pool.h>
 #include <rime/context.h>
 #include <rime/engine.h>
 #include <rime/resource.h>
 #include <rime/schema.h>
 #include <rime/service.h>
+#include <rime/thread_pool.h>
 
 using namespace std::placeholders;
 
@@ -139,11 +141,28 @@ void Service::CleanupStaleSessions() {
   }
   if (count > 0) {
     LOG(INFO) << "Recycled " << count << " stale sessions.";
+    BlockPool::Trim();
   }
 }
 
 void Service::CleanupAllSessions() {
   sessions_.clear();
+  // let go of retained files, too, which may be about to be rebuilt or synced.
+  retention_.Clear();
+  // and of the blocks freed with the sessions.
+  BlockPool::Trim();
+}
+
+ThreadPool* Service::translation_pool() {
+  std::call_once(translation_pool_started_, [this] {
+    const size_t kMaxThreads = 3;
+    size_t num_cores = std::thread::hardware_concurrency();
+    size_t num_threads = num_cores > 1 ? (std::min)(kMaxThreads, num_cores - 1)
+                                       : 0;  // run in turn
+    LOG(INFO) << "starting " << num_threads << " translation threads.";
+    translation_pool_.reset(new ThreadPool(num_threads));
+  });
+  return translation_pool_.get();
 }
 
 void Service::SetNotificationHandler(const NotificationHandler& handler) {
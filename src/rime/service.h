@@ -12,6 +12,7 @@
 #include <mutex>
 #include <rime/common.h>
 #include <rime/deployer.h>
+#include <rime/retention_cache.h>
 
 namespace rime {
 
@@ -55,6 +56,7 @@ class Session {
 
 class ResourceResolver;
 struct ResourceType;
+class ThreadPool;
 
 class RIME_DLL Service {
  public:
@@ -82,6 +84,10 @@ class RIME_DLL Service {
   ResourceResolver* CreateStagingResourceResolver(const ResourceType& type);
 
   Deployer& deployer() { return deployer_; }
+  RetentionCache& retention() { return retention_; }
+  // worker threads shared by the engines of all sessions translating in
+  // parallel; started on first use.
+  ThreadPool* translation_pool();
   bool disabled() { return !started_ || deployer_.IsMaintenanceMode(); }
 
   static Service& instance();
@@ -92,9 +98,12 @@ class RIME_DLL Service {
   using SessionMap = map<SessionId, an<Session>>;
   SessionMap sessions_;
   Deployer deployer_;
+  RetentionCache retention_;
   NotificationHandler notification_handler_;
   std::mutex mutex_;
   bool started_ = false;
+  std::once_flag translation_pool_started_;
+  the<ThreadPool> translation_pool_;
 };
 
 }  // namespace rime
@@ -0,0 +1,56 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <rime/thread_pool.h>
+
+namespace rime {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+#ifndef RIME_NO_THREADING
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this] { Work(); });
+  }
+#endif  // RIME_NO_THREADING
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  has_task_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Enqueue(function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  has_task_.notify_one();
+}
+
+void ThreadPool::Work() {
+  while (true) {
+    function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      has_task_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty())
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace rime
@@ -0,0 +1,55 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#ifndef RIME_THREAD_POOL_H_
+#define RIME_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// A fixed number of worker threads running posted tasks in order.
+// Threads are joined on destruction, after finishing the tasks in the queue.
+// Without threading support, tasks are run by the posting thread.
+class ThreadPool {
+ public:
+  RIME_DLL explicit ThreadPool(size_t num_threads);
+  RIME_DLL ~ThreadPool();
+
+  // runs `task` on a worker thread; the future holds its result, or the
+  // exception it throws.
+  template <class F>
+  std::future<decltype(std::declval<F>()())> Post(F&& task) {
+    using R = decltype(std::declval<F>()());
+    auto packaged_task =
+        std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    auto result = packaged_task->get_future();
+    Enqueue([packaged_task] { (*packaged_task)(); });
+    return result;
+  }
+
+  size_t size() const { return workers_.size(); }
+
+ private:
+  RIME_DLL void Enqueue(function<void()> task);
+  void Work();
+
+  vector<std::thread> workers_;
+  std::deque<function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable has_task_;
+  bool stopping_ = false;
+};
+
+}  // namespace rime
+
+#endif  // RIME_THREAD_POOL_H_
@@ -112,7 +112,8 @@ bool MergedTranslation::Next() {
     DLOG(INFO) << "translation #" << elected_ << " has been exhausted.";
     translations_.erase(translations_.begin() + elected_);
   }
-  Elect();
+  // only the translations next to the one that advanced compare differently.
+  Elect(elected_ > 0 ? elected_ - 1 : 0);
   return !exhausted();
 }
 
@@ -123,24 +124,26 @@ an<Candidate> MergedTranslation::Peek() {
   return translations_[elected_]->Peek();
 }
 
-void MergedTranslation::Elect() {
+void MergedTranslation::Elect(size_t start) {
   if (translations_.empty()) {
     set_exhausted(true);
     return;
   }
-  size_t k = 0;
-  for (; k < translations_.size(); ++k) {
+  size_t k = start;
+  while (k < translations_.size()) {
     const auto& current = translations_[k];
     const auto& next =
         k + 1 < translations_.size() ? translations_[k + 1] : nullptr;
     if (current->Compare(next, previous_candidates_) <= 0) {
       if (current->exhausted()) {
         translations_.erase(translations_.begin() + k);
-        k = 0;
+        // the previous translation has a new one to compare with.
+        k = k > 0 ? k - 1 : 0;
         continue;
       }
       break;
     }
+    ++k;
   }
   elected_ = k;
   if (k >= translations_.size()) {
@@ -154,7 +157,8 @@ void MergedTranslation::Elect() {
 MergedTranslation& MergedTranslation::operator+=(an<Translation> t) {
   if (t && !t->exhausted()) {
     translations_.push_back(t);
-    Elect();
+    // the elected translation stays unless it was the last one.
+    Elect(exhausted() ? 0 : elected_);
   }
   return *this;
 }
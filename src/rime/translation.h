@@ -94,7 +94,9 @@ class MergedTranslation : public Translation {
   size_t size() const { return translations_.size(); }
 
  protected:
-  void Elect();
+  // elects the first translation not giving up to the next one, resuming
+  // from translation #start; those before it are known to give up.
+  void Elect(size_t start = 0);
 
   const CandidateList& previous_candidates_;
   vector<of<Translation>> translations_;
@@ -28,6 +28,16 @@ class Translator : public Class<Translator, const Ticket&> {
   virtual an<Translation> Query(const string& input,
                                 const Segment& segment) = 0;
 
+  // returns true if Query can run on a worker thread, concurrently with
+  // queries of other translators, when the schema sets
+  // engine/parallel_translation. such a translator must not, in Query,
+  // modify anything but its own members, nor call objects shared with other
+  // translators unless they are safe to call from multiple threads; it can
+  // read the engine's context and schema, which stay unchanged until all
+  // queries return. the translation it returns is used on the engine's
+  // thread only.
+  virtual bool concurrent_query() const { return false; }
+
   string name_space() const { return name_space_; }
 
  protected:
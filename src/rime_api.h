@@ -505,6 +505,19 @@ typedef struct RIME_FLAVORED(rime_api_t) {
                                               size_t index);
 
   Bool (*change_page)(RimeSessionId session_id, Bool backward);
+
+  //! prepare candidates of the current menu, up to `count` in total,
+  //! spending at most `max_milliseconds` (0 for no limit) in this call.
+  //! returns the number of candidates ready to be read with
+  //! candidate_list_from_index, and sets *has_more to False once all
+  //! candidates are prepared. call again to resume an unfinished preparation.
+  //! candidate_list_next prepares any candidate it reaches without a limit;
+  //! to scroll through a long menu within a time budget, read no further
+  //! than the number returned here.
+  size_t (*prepare_candidates)(RimeSessionId session_id,
+                               size_t count,
+                               int max_milliseconds,
+                               Bool* has_more);
 } RIME_FLAVORED(RimeApi);
 
 //! API entry
@@ -1027,6 +1027,28 @@ static Bool RimeChangePage(RimeSessionId session_id, Bool backward) {
   return Bool(ctx->Highlight(index));
 }
 
+static size_t RimePrepareCandidates(RimeSessionId session_id,
+                                    size_t count,
+                                    int max_milliseconds,
+                                    Bool* has_more) {
+  if (has_more)
+    *has_more = False;
+  an<Session> session(Service::instance().GetSession(session_id));
+  if (!session)
+    return 0;
+  Context* ctx = session->context();
+  if (!ctx || !ctx->HasMenu())
+    return 0;
+  Menu* menu = ctx->composition().back().menu.get();
+  Menu::Budget budget;
+  budget.max_time =
+      std::chrono::milliseconds((std::max)(0, max_milliseconds));
+  size_t ready = menu->Prepare(count, budget);
+  if (has_more)
+    *has_more = Bool(!menu->exhausted());
+  return ready;
+}
+
 static Bool RimeHighlightCandidate(RimeSessionId session_id, size_t index) {
   return (Bool)do_with_candidate(session_id, index, &Context::Highlight);
 }
@@ -1232,6 +1254,7 @@ RIME_API RIME_FLAVORED(RimeApi) * RIME_FLAVORED(rime_get_api)() {
     s_api.highlight_candidate_on_current_page =
         &RimeHighlightCandidateOnCurrentPage;
     s_api.change_page = &RimeChangePage;
+    s_api.prepare_candidates = &RimePrepareCandidates;
   }
   return &s_api;
 }
@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include <rime/common.h>
 #include <rime/algo/algebra.h>
+#include <rime/algo/calculus.h>
 
 static const char* kTransliteration =
     "xlit/ABCDEFGHIJKLMNOPQRSTUVWXYZ/abcdefghijklmnopqrstuvwxyz/";
@@ -76,3 +77,38 @@ TEST(RimeAlgebraTest, Projection) {
   EXPECT_EQ(rime::kAbbreviation, s["sh"][0].properties.type);
   EXPECT_DOUBLE_EQ(log(0.5), s["sh"][0].properties.credibility);
 }
+
+TEST(RimeAlgebraTest, CombinedTransliteration) {
+  const char* formulas[] = {"xlit/abc/bcd/", "xlit/de/ed/"};
+  auto c = rime::New<rime::ConfigList>();
+  rime::Calculus calc;
+  rime::vector<rime::of<rime::Calculation>> chain;
+  for (const char* formula : formulas) {
+    c->Append(rime::New<rime::ConfigValue>(formula));
+    chain.emplace_back(calc.Parse(formula));
+  }
+  rime::Projection p;
+  ASSERT_TRUE(p.Load(c));
+  rime::Projection memoized;
+  ASSERT_TRUE(memoized.Load(c));
+  memoized.EnableMemo(2);
+
+  for (const rime::string& input :
+       {rime::string("abcdef"), rime::string("xyz"), rime::string("eee"),
+        rime::string(100, 'a'), rime::string("abcdef")}) {
+    rime::Spelling expected(input);
+    bool expected_modified = false;
+    for (const auto& x : chain) {
+      expected_modified = x->Apply(&expected) || expected_modified;
+    }
+    rime::string str(input);
+    EXPECT_EQ(expected_modified, p.Apply(&str));
+    EXPECT_EQ(expected.str, str);
+    rime::string memoized_str(input);
+    EXPECT_EQ(expected_modified, memoized.Apply(&memoized_str));
+    EXPECT_EQ(expected.str, memoized_str);
+  }
+  rime::string str("abcdef");
+  p.Apply(&str);
+  EXPECT_EQ("bceedf", str);
+}
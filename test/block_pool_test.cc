@@ -0,0 +1,95 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <thread>
+#include <gtest/gtest.h>
+#include <rime/block_pool.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/context.h>
+
+using namespace rime;
+
+class RimeBlockPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override { BlockPool::Trim(); }
+  void TearDown() override { BlockPool::Trim(); }
+};
+
+TEST_F(RimeBlockPoolTest, ReusesBlocksOfSizeClass) {
+  for (size_t size : {16, 512}) {
+    void* block = BlockPool::Allocate(size);
+    BlockPool::Deallocate(block, size);
+    EXPECT_EQ(size, BlockPool::free_bytes());
+    size_t heap_allocations = BlockPool::stats().heap_allocations;
+    // a smaller block of the same size class.
+    void* reused = BlockPool::Allocate(size - 1);
+    EXPECT_EQ(block, reused);
+    EXPECT_EQ(heap_allocations, BlockPool::stats().heap_allocations);
+    EXPECT_EQ(0, BlockPool::free_bytes());
+    BlockPool::Deallocate(reused, size - 1);
+    BlockPool::Trim();
+  }
+}
+
+TEST_F(RimeBlockPoolTest, LargeBlocksComeFromHeap) {
+  const size_t kSize = BlockPool::kMaxBlockSize + 1;
+  size_t heap_allocations = BlockPool::stats().heap_allocations;
+  void* block = BlockPool::Allocate(kSize);
+  BlockPool::Deallocate(block, kSize);
+  EXPECT_EQ(0, BlockPool::free_bytes());
+  BlockPool::Deallocate(BlockPool::Allocate(kSize), kSize);
+  EXPECT_EQ(heap_allocations + 2, BlockPool::stats().heap_allocations);
+}
+
+TEST_F(RimeBlockPoolTest, KeepsLimitedFreeBytesPerSizeClass) {
+  const size_t kNumBlocks = BlockPool::kMaxFreeBytes / 16 + 10;
+  vector<void*> blocks;
+  for (size_t i = 0; i < kNumBlocks; ++i) {
+    blocks.push_back(BlockPool::Allocate(16));
+  }
+  void* other = BlockPool::Allocate(32);
+  for (void* block : blocks) {
+    BlockPool::Deallocate(block, 16);
+  }
+  EXPECT_EQ(BlockPool::kMaxFreeBytes, BlockPool::free_bytes());
+  // other size classes have their own limits.
+  BlockPool::Deallocate(other, 32);
+  EXPECT_EQ(BlockPool::kMaxFreeBytes + 32, BlockPool::free_bytes());
+  BlockPool::Trim();
+  EXPECT_EQ(0, BlockPool::free_bytes());
+}
+
+TEST_F(RimeBlockPoolTest, BlockFreedOnAnotherThread) {
+  void* block = BlockPool::Allocate(64);
+  std::thread([block] {
+    BlockPool::Deallocate(block, 64);
+    // kept by the thread that frees it, and reused there.
+    EXPECT_EQ(64, BlockPool::free_bytes());
+    void* reused = BlockPool::Allocate(64);
+    EXPECT_EQ(block, reused);
+    BlockPool::Deallocate(reused, 64);
+  }).join();
+  EXPECT_EQ(0, BlockPool::free_bytes());
+}
+
+TEST_F(RimeBlockPoolTest, PoolsOnlyObjectsMadeWithNewPooled) {
+  size_t allocations = BlockPool::stats().allocations;
+  auto value = New<string>("heap");
+  EXPECT_EQ(allocations, BlockPool::stats().allocations);
+  auto cand = NewPooled<SimpleCandidate>("test", 0, 1, "pooled");
+  EXPECT_EQ(allocations + 1, BlockPool::stats().allocations);
+  cand.reset();
+  EXPECT_LT(0, BlockPool::free_bytes());
+}
+
+TEST_F(RimeBlockPoolTest, TrimmedWhenCompositionCleared) {
+  Context ctx;
+  ctx.set_input("abc");
+  BlockPool::Deallocate(BlockPool::Allocate(64), 64);
+  EXPECT_EQ(64, BlockPool::free_bytes());
+  ctx.Clear();
+  EXPECT_EQ(0, BlockPool::free_bytes());
+}
@@ -0,0 +1,60 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/gear/cached_grammar.h>
+
+using namespace rime;
+
+namespace {
+
+class CountingGrammar : public Grammar {
+ public:
+  explicit CountingGrammar(int* num_queries) : num_queries_(num_queries) {}
+
+  double Query(const string& context, const string& word, bool is_rear) {
+    ++*num_queries_;
+    return -double(context.length() + word.length()) - (is_rear ? 0.5 : 0.0);
+  }
+
+ private:
+  int* num_queries_;
+};
+
+}  // namespace
+
+TEST(RimeCachedGrammarTest, QueryOnce) {
+  int num_queries = 0;
+  CachedGrammar grammar(new CountingGrammar(&num_queries));
+  EXPECT_EQ(-3.0, grammar.Query("a", "bc", false));
+  EXPECT_EQ(-3.5, grammar.Query("a", "bc", true));
+  EXPECT_EQ(-3.0, grammar.Query("a", "bc", false));
+  EXPECT_EQ(2, num_queries);
+
+  string bc("bc"), d("d");
+  const string* words[] = {&bc, &d, &bc};
+  double scores[3];
+  grammar.QueryBatch("a", words, 3, false, scores);
+  EXPECT_EQ(-3.0, scores[0]);
+  EXPECT_EQ(-2.0, scores[1]);
+  EXPECT_EQ(-3.0, scores[2]);
+  EXPECT_EQ(3, num_queries);
+  EXPECT_EQ(3, grammar.stats().hits);
+  EXPECT_EQ(3, grammar.stats().misses);
+}
+
+TEST(RimeCachedGrammarTest, ResetWhenFull) {
+  int num_queries = 0;
+  CachedGrammar grammar(new CountingGrammar(&num_queries), 2);
+  grammar.Query("", "a", false);
+  grammar.Query("", "b", false);
+  EXPECT_EQ(2, grammar.size());
+  grammar.Query("", "c", false);
+  EXPECT_EQ(1, grammar.size());
+  EXPECT_EQ(1, grammar.stats().resets);
+  grammar.Query("", "a", false);
+  EXPECT_EQ(4, num_queries);
+}
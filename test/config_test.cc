@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include <rime/component.h>
 #include <rime/config.h>
+#include <rime/config/config_data.h>
 
 using namespace rime;
 
@@ -52,6 +53,74 @@ TEST(RimeConfigComponentTest, RoundTrip) {
   r.Unregister("test_config");
 }
 
+TEST(RimeConfigComponentTest, SharedCache) {
+  the<ConfigComponent<ConfigLoader>> component(
+      new ConfigComponent<ConfigLoader>);
+  component->set_shared_cache(true);
+  the<Config> config(component->Create("config_test"));
+  the<Config> another(component->Create("config_test"));
+  // the parsed tree is shared, and read in place
+  int lost = 0;
+  EXPECT_TRUE(config->GetInt("zerg/zergling/lost", &lost));
+  EXPECT_EQ(1234, lost);
+  // modifications are copied on write
+  EXPECT_TRUE(config->SetString("protoss/residence", "Shakuras"));
+  string value;
+  EXPECT_TRUE(config->GetString("protoss/residence", &value));
+  EXPECT_EQ("Shakuras", value);
+  EXPECT_TRUE(another->GetString("protoss/residence", &value));
+  EXPECT_EQ("Aiur", value);
+  // so are nodes handed out, which can be modified in place
+  auto zerg = config->GetMap("zerg");
+  ASSERT_TRUE(bool(zerg));
+  EXPECT_EQ(zerg, config->GetMap("zerg"));
+  zerg->Set("residence", New<ConfigValue>("Char"));
+  (*config)["zerg"]["zergling"]["lost"] = 0;
+  EXPECT_TRUE(config->GetString("zerg/residence", &value));
+  EXPECT_EQ("Char", value);
+  EXPECT_TRUE(config->GetInt("zerg/zergling/lost", &lost));
+  EXPECT_EQ(0, lost);
+  EXPECT_NE(zerg, another->GetMap("zerg"));
+  EXPECT_FALSE(another->GetString("zerg/residence", &value));
+  EXPECT_TRUE(another->GetInt("zerg/zergling/lost", &lost));
+  EXPECT_EQ(1234, lost);
+  the<Config> new_one(component->Create("config_test"));
+  EXPECT_TRUE(new_one->GetString("protoss/residence", &value));
+  EXPECT_EQ("Aiur", value);
+  EXPECT_FALSE(new_one->GetString("zerg/residence", &value));
+  EXPECT_TRUE(new_one->GetInt("zerg/zergling/lost", &lost));
+  EXPECT_EQ(1234, lost);
+}
+
+TEST(RimeConfigDataTest, BinaryRoundTrip) {
+  const path file_path("config_test.yaml");
+  const path binary_file_path("config_binary_round_trip_test.bin");
+  auto source = New<ConfigData>();
+  ASSERT_TRUE(source->LoadFromFile(file_path, nullptr));
+  ASSERT_TRUE(source->SaveToBinaryFile(binary_file_path));
+  auto data = New<ConfigData>();
+  ASSERT_TRUE(data->LoadFromBinaryFile(binary_file_path, file_path));
+  EXPECT_EQ(file_path, data->file_path());
+  EXPECT_FALSE(data->modified());
+  Config config(data);
+  string value;
+  EXPECT_TRUE(config.GetString("protoss/residence", &value));
+  EXPECT_EQ("Aiur", value);
+  EXPECT_EQ(4, config.GetListSize("protoss/air_force"));
+  EXPECT_TRUE(config.GetString("protoss/air_force/@3", &value));
+  EXPECT_EQ("arbiter", value);
+  int lost = 0;
+  EXPECT_TRUE(config.GetInt("zerg/zergling/lost", &lost));
+  EXPECT_EQ(1234, lost);
+  // a stale image is rejected
+  auto mtime = std::filesystem::last_write_time(file_path);
+  std::filesystem::last_write_time(binary_file_path,
+                                   mtime - std::chrono::seconds(1));
+  EXPECT_FALSE(New<ConfigData>()->LoadFromBinaryFile(binary_file_path,
+                                                     file_path));
+  std::filesystem::remove(binary_file_path);
+}
+
 TEST(RimeConfigItemTest, NullItem) {
   ConfigItem item;
   EXPECT_EQ(ConfigItem::kNull, item.type());
@@ -0,0 +1,95 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/translation.h>
+#include <rime/dict/vocabulary.h>
+#include <rime/gear/contextual_translation.h>
+#include <rime/gear/grammar.h>
+#include <rime/gear/translator_commons.h>
+
+using namespace rime;
+
+namespace {
+
+// favors words ending in "0" by 2.0.
+class TestGrammar : public Grammar {
+ public:
+  double Query(const string& context, const string& word, bool is_rear) {
+    ++num_queries;
+    return word.back() == '0' ? 0.0 : -2.0;
+  }
+  void QueryBatch(const string& context,
+                  const string* const words[],
+                  size_t num_words,
+                  bool is_rear,
+                  double scores[]) {
+    ++num_batches;
+    Grammar::QueryBatch(context, words, num_words, is_rear, scores);
+  }
+  double MaxScore(bool is_rear) const { return 0.0; }
+
+  int num_queries = 0;
+  int num_batches = 0;
+};
+
+an<Translation> MakePhrases(const string& type, const vector<double>& weights) {
+  auto phrases = New<FifoTranslation>();
+  for (size_t i = 0; i < weights.size(); ++i) {
+    auto entry = New<DictEntry>();
+    entry->text = "w" + std::to_string(i);
+    entry->weight = weights[i];
+    phrases->Append(New<Phrase>(nullptr, type, 0, 2, entry));
+  }
+  return phrases;
+}
+
+vector<string> TopTexts(Translation* translation, size_t count) {
+  vector<string> texts;
+  for (; texts.size() < count && !translation->exhausted();
+       translation->Next()) {
+    texts.push_back(translation->Peek()->text());
+  }
+  return texts;
+}
+
+}  // namespace
+
+TEST(RimeContextualTranslationTest, StopsPullingUnrankablePhrases) {
+  vector<double> weights(100);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = -0.3 * i;
+  }
+  TestGrammar grammar;
+  ContextualTranslation translation(MakePhrases("phrase", weights), "abc",
+                                    "context", &grammar);
+  // w10 (-3.0) gets ahead of w4 (-1.2 - 2.0).
+  vector<string> expected = {"w0", "w1", "w2", "w3", "w10"};
+  EXPECT_EQ(expected, TopTexts(&translation, 5));
+  EXPECT_LT(grammar.num_queries, 20);
+  // phrases are scored in batches.
+  EXPECT_LT(grammar.num_batches, grammar.num_queries);
+  EXPECT_FALSE(translation.exhausted());
+}
+
+TEST(RimeContextualTranslationTest, SortsGroupsNotOrderedByWeight) {
+  // completions are ordered by the length of the code to complete, so w9
+  // follows phrases of lower weights.
+  vector<double> weights(10);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = -0.3 * i;
+  }
+  weights[9] = 0.0;
+  TestGrammar grammar;
+  ContextualTranslation translation(MakePhrases("completion", weights), "abc",
+                                    "context", &grammar);
+  // w9 (0.0 - 2.0) gets ahead of w1 (-0.3 - 2.0).
+  vector<string> expected = {"w0", "w9", "w1", "w2", "w3"};
+  EXPECT_EQ(expected, TopTexts(&translation, 5));
+  EXPECT_EQ(1, grammar.num_batches);
+}
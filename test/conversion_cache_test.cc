@@ -0,0 +1,54 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/gear/conversion_cache.h>
+
+using namespace rime;
+
+using Forms = ConversionCache::Forms;
+
+TEST(RimeConversionCacheTest, FindsConvertedForms) {
+  ConversionCache cache(4);
+  an<const Forms> forms;
+  EXPECT_FALSE(cache.Find("\xe9\xac\xb1", &forms));  // 鬱
+
+  auto converted = New<Forms>(Forms{"\xe9\x83\x81"});  // 郁
+  cache.Insert("\xe9\xac\xb1", converted);
+  ASSERT_TRUE(cache.Find("\xe9\xac\xb1", &forms));
+  EXPECT_EQ(converted, forms);
+
+  // the first conversion is kept for a text converted again meanwhile.
+  cache.Insert("\xe9\xac\xb1", New<Forms>(Forms{"x"}));
+  ASSERT_TRUE(cache.Find("\xe9\xac\xb1", &forms));
+  EXPECT_EQ(converted, forms);
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(RimeConversionCacheTest, CachesUnchangedText) {
+  ConversionCache cache(4);
+  cache.Insert("abc", nullptr);
+  an<const Forms> forms = New<Forms>();
+  ASSERT_TRUE(cache.Find("abc", &forms));
+  EXPECT_FALSE(bool(forms));
+}
+
+TEST(RimeConversionCacheTest, DropsLeastRecentlyUsed) {
+  const size_t kCapacity = 3;
+  ConversionCache cache(kCapacity);
+  an<const Forms> forms;
+  for (const char* text : {"a", "b", "c"}) {
+    cache.Insert(text, nullptr);
+  }
+  // `a` is used again, leaving `b` the least recently used.
+  ASSERT_TRUE(cache.Find("a", &forms));
+  cache.Insert("d", nullptr);
+  EXPECT_EQ(kCapacity, cache.size());
+  EXPECT_FALSE(cache.Find("b", &forms));
+  EXPECT_TRUE(cache.Find("a", &forms));
+  EXPECT_TRUE(cache.Find("c", &forms));
+  EXPECT_TRUE(cache.Find("d", &forms));
+}
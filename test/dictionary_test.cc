@@ -4,12 +4,15 @@
 //
 // 2011-07-05 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <rime/common.h>
+#include <rime/algo/algebra.h>
 #include <rime/algo/encoder.h>
 #include <rime/algo/syllabifier.h>
 #include <rime/dict/dictionary.h>
 #include <rime/dict/dict_compiler.h>
+#include <rime/dict/reverse_lookup_dictionary.h>
 
 class RimeDictionaryTest : public ::testing::Test {
  public:
@@ -66,6 +69,92 @@ TEST_F(RimeDictionaryTest, PredictiveLookup) {
   EXPECT_EQ("za", raw_code.ToString());
 }
 
+TEST_F(RimeDictionaryTest, ViewFilter) {
+  ASSERT_TRUE(dict_->loaded());
+  const rime::string kRejected = "\xe4\xb8\xad";  // 中
+  rime::vector<rime::string> expected;
+  rime::DictEntryIterator all;
+  dict_->LookupWords(&all, "zhong", false);
+  for (; !all.exhausted(); all.Next()) {
+    EXPECT_EQ(all.Peek()->text, all.PeekView().text());
+    EXPECT_EQ(all.Peek()->weight, all.PeekView().weight());
+    if (all.Peek()->text != kRejected)
+      expected.push_back(all.Peek()->text);
+  }
+  ASSERT_FALSE(expected.empty());
+
+  rime::DictEntryIterator it;
+  dict_->LookupWords(&it, "zhong", false);
+  it.AddViewFilter([&](const rime::DictEntryView& view) {
+    return view.text() != kRejected;
+  });
+  rime::vector<rime::string> seen_by_entry_filter;
+  it.AddFilter([&](rime::an<rime::DictEntry> entry) {
+    seen_by_entry_filter.push_back(entry->text);
+    return true;
+  });
+  rime::vector<rime::string> actual;
+  for (; !it.exhausted(); it.Next()) {
+    actual.push_back(it.Peek()->text);
+  }
+  EXPECT_EQ(expected, actual);
+  // rejected entries are dropped before DictEntry objects are made.
+  EXPECT_EQ(expected, seen_by_entry_filter);
+}
+
+TEST_F(RimeDictionaryTest, FilterByCharset) {
+  ASSERT_TRUE(dict_->loaded());
+  const rime::string kExtended = "\xf0\xa0\x80\x80";  // U+20000
+  rime::DictEntryIterator all;
+  dict_->LookupWords(&all, "zhong", false);
+  rime::DictEntryIterator basic;
+  dict_->LookupWords(&basic, "zhong", false, 0, nullptr, true);
+  size_t num_extended = 0;
+  for (; !all.exhausted(); all.Next()) {
+    if (all.Peek()->text == kExtended) {
+      EXPECT_TRUE(all.PeekView().has_extended_cjk());
+      ++num_extended;
+      continue;
+    }
+    ASSERT_FALSE(basic.exhausted());
+    EXPECT_EQ(all.Peek()->text, basic.Peek()->text);
+    basic.Next();
+  }
+  EXPECT_EQ(1, num_extended);
+  EXPECT_TRUE(basic.exhausted());
+
+  rime::SyllableGraph g;
+  rime::Syllabifier s;
+  ASSERT_TRUE(s.BuildSyllableGraph("zhong", *dict_->prism(), &g) > 0);
+  auto c = dict_->Lookup(g, 0, nullptr, false, 0.0, true);
+  ASSERT_TRUE(c && c->find(5) != c->end());
+  for (auto& it = (*c)[5]; !it.exhausted(); it.Next()) {
+    EXPECT_NE(kExtended, it.Peek()->text);
+  }
+}
+
+TEST_F(RimeDictionaryTest, LookupComments) {
+  auto db =
+      rime::New<rime::ReverseDb>(rime::path{"dictionary_test.reverse.bin"});
+  rime::ReverseLookupDictionary rev_dict(db);
+  ASSERT_TRUE(rev_dict.Load());
+  auto formulas = rime::New<rime::ConfigList>();
+  formulas->Append(rime::New<rime::ConfigValue>("xform/^/[/"));
+  rime::Projection formatter;
+  ASSERT_TRUE(formatter.Load(formulas));
+  const rime::vector<rime::string> texts{"\xe4\xb8\xad",  // 中
+                                         "not found"};
+  for (int round = 0; round < 2; ++round) {  // then from the cache
+    rime::vector<rime::string> comments;
+    rev_dict.LookupComments(texts, &formatter, &comments);
+    ASSERT_EQ(2, comments.size());
+    rime::string codes;
+    ASSERT_TRUE(rev_dict.ReverseLookup(texts[0], &codes));
+    EXPECT_EQ("[" + codes, comments[0]);
+    EXPECT_EQ("", comments[1]);
+  }
+}
+
 TEST_F(RimeDictionaryTest, ScriptLookup) {
   ASSERT_TRUE(dict_->loaded());
   rime::SyllableGraph g;
@@ -101,3 +190,55 @@ TEST_F(RimeDictionaryTest, ScriptLookup) {
   EXPECT_EQ(9, e3->text.length());
   EXPECT_FALSE(d7.Next());
 }
+
+static rime::vector<rime::string> LookupTexts(rime::DictEntryIterator& it) {
+  rime::vector<rime::string> texts;
+  for (; !it.exhausted(); it.Next()) {
+    texts.push_back(it.Peek()->text);
+  }
+  return texts;
+}
+
+TEST(RimeDictionaryPackTest, MergedTable) {
+  rime::DictionaryComponent component;
+  rime::the<rime::Dictionary> merged(component.Create(
+      "dictionary_test", "dictionary_test", {"dictionary_test_pack"}, true));
+  ASSERT_TRUE(bool(merged->merged_table()));
+  {
+    rime::DictCompiler dict_compiler(merged.get());
+    ASSERT_TRUE(dict_compiler.Compile(rime::path()));
+  }
+  ASSERT_TRUE(merged->Load());
+  ASSERT_TRUE(merged->merged_table()->IsOpen());
+  rime::the<rime::Dictionary> unmerged(component.Create(
+      "dictionary_test", "dictionary_test", {"dictionary_test_pack"}));
+  ASSERT_TRUE(unmerged->Load());
+  ASSERT_TRUE(unmerged->tables()[1]->IsOpen());
+
+  for (bool predictive : {false, true}) {
+    rime::DictEntryIterator a;
+    rime::DictEntryIterator b;
+    merged->LookupWords(&a, "zhong", predictive);
+    unmerged->LookupWords(&b, "zhong", predictive);
+    auto texts = LookupTexts(a);
+    EXPECT_EQ(LookupTexts(b), texts);
+    EXPECT_NE(texts.end(),
+              std::find(texts.begin(), texts.end(), "\xe7\x9b\x85"));  // 盅
+  }
+
+  rime::SyllableGraph g;
+  rime::Syllabifier s;
+  ASSERT_TRUE(s.BuildSyllableGraph("zhongwenshurufa", *merged->prism(), &g) >
+              0);
+  auto c1 = merged->Lookup(g, 0);
+  auto c2 = unmerged->Lookup(g, 0);
+  ASSERT_TRUE(c1 && c2);
+  // 中文输入法 from the pack, coded with 5 syllables.
+  ASSERT_TRUE(c1->find(15) != c1->end());
+  EXPECT_EQ(15, (*c1)[15].Peek()->text.length());
+  ASSERT_EQ(c2->size(), c1->size());
+  for (auto& x : *c2) {
+    ASSERT_TRUE(c1->find(x.first) != c1->end());
+    EXPECT_EQ(LookupTexts(x.second), LookupTexts((*c1)[x.first]));
+  }
+}
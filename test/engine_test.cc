@@ -0,0 +1,306 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <gtest/gtest.h>
+#include <rime/block_pool.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/component.h>
+#include <rime/composition.h>
+#include <rime/config.h>
+#include <rime/context.h>
+#include <rime/engine.h>
+#include <rime/filter.h>
+#include <rime/key_event.h>
+#include <rime/menu.h>
+#include <rime/schema.h>
+#include <rime/segmentation.h>
+#include <rime/service.h>
+#include <rime/thread_pool.h>
+#include <rime/translation.h>
+#include <rime/translator.h>
+
+using namespace rime;
+
+namespace {
+
+// translates segments with its tag, `abc` by default, into a candidate
+// named after its name space, or as many as the option `candidates` asks.
+class TestTranslator : public Translator {
+ public:
+  explicit TestTranslator(const Ticket& ticket) : Translator(ticket) {
+    ++num_created;
+    Config* config = ticket.schema->config();
+    if (!config->GetString(name_space_ + "/tag", &tag_))
+      tag_ = "abc";
+    config->GetBool(name_space_ + "/concurrent", &concurrent_);
+    config->GetInt(name_space_ + "/candidates", &num_candidates_);
+  }
+
+  bool concurrent_query() const override { return concurrent_; }
+
+  an<Translation> Query(const string& input, const Segment& segment) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++num_queries;
+      queries.emplace_back(name_space_, std::this_thread::get_id());
+    }
+    if (!segment.HasTag(tag_))
+      return nullptr;
+    if (num_candidates_ > 1) {
+      auto translation = New<FifoTranslation>();
+      for (int i = 0; i < num_candidates_; ++i) {
+        translation->Append(NewPooled<SimpleCandidate>(
+            "test", segment.start, segment.end,
+            name_space_ + ":" + input + std::to_string(i)));
+      }
+      return translation;
+    }
+    return New<UniqueTranslation>(NewPooled<SimpleCandidate>(
+        "test", segment.start, segment.end, name_space_ + ":" + input));
+  }
+
+  static int num_created;
+  static int num_queries;
+  // name spaces of the translators queried, and the threads querying them.
+  static vector<pair<string, std::thread::id>> queries;
+  static std::mutex mutex;
+
+ private:
+  string tag_;
+  bool concurrent_ = false;
+  int num_candidates_ = 1;
+};
+
+int TestTranslator::num_created = 0;
+int TestTranslator::num_queries = 0;
+vector<pair<string, std::thread::id>> TestTranslator::queries;
+std::mutex TestTranslator::mutex;
+
+// appends a candidate named after its name space.
+class TestFilter : public Filter {
+ public:
+  explicit TestFilter(const Ticket& ticket) : Filter(ticket) { ++num_created; }
+
+  an<Translation> Apply(an<Translation> translation,
+                        CandidateList* candidates) override {
+    ++num_applied;
+    return translation + New<UniqueTranslation>(New<SimpleCandidate>(
+                             "test", 0, 0, name_space_));
+  }
+
+  static int num_created;
+  static int num_applied;
+};
+
+int TestFilter::num_created = 0;
+int TestFilter::num_applied = 0;
+
+an<ConfigList> MakeList(const vector<string>& values) {
+  auto list = New<ConfigList>();
+  for (const auto& value : values) {
+    list->Append(New<ConfigValue>(value));
+  }
+  return list;
+}
+
+}  // namespace
+
+class RimeEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Registry::instance().Register("test_translator",
+                                  new Component<TestTranslator>);
+    Registry::instance().Register("test_filter", new Component<TestFilter>);
+    TestTranslator::num_created = TestTranslator::num_queries = 0;
+    TestTranslator::queries.clear();
+    TestFilter::num_created = TestFilter::num_applied = 0;
+  }
+
+  void TearDown() override {
+    Registry::instance().Unregister("test_translator");
+    Registry::instance().Unregister("test_filter");
+  }
+
+  // a schema with translators `a`, `b` tagged `other`, and a filter.
+  static Schema* CreateSchema(bool lazy_loading) {
+    auto* config = new Config;
+    config->SetItem("engine/segmentors", MakeList({"abc_segmentor"}));
+    config->SetItem("engine/translators",
+                    MakeList({"test_translator@a", "test_translator@b"}));
+    config->SetItem("engine/filters", MakeList({"test_filter@f"}));
+    config->SetString("b/tag", "other");
+    config->SetString("engine/lazy_loading", lazy_loading ? "true" : "false");
+    return new Schema("engine_test", config);
+  }
+
+  // a schema with translators `a` to `d`, of which `a` and `c` support
+  // concurrent queries.
+  static Schema* CreateParallelSchema(bool parallel_translation,
+                                      bool lazy_loading) {
+    auto* config = new Config;
+    config->SetItem("engine/segmentors", MakeList({"abc_segmentor"}));
+    config->SetItem("engine/translators",
+                    MakeList({"test_translator@a", "test_translator@b",
+                              "test_translator@c", "test_translator@d"}));
+    config->SetItem("engine/filters", MakeList({"test_filter@f"}));
+    config->SetString("a/concurrent", "true");
+    config->SetString("c/concurrent", "true");
+    config->SetString("engine/parallel_translation",
+                      parallel_translation ? "true" : "false");
+    config->SetString("engine/lazy_loading", lazy_loading ? "true" : "false");
+    return new Schema("engine_test", config);
+  }
+
+  static vector<string> Translate(Engine* engine, const string& input) {
+    Context* ctx = engine->context();
+    ctx->set_input(input);
+    vector<string> texts;
+    if (!ctx->HasMenu())
+      return texts;
+    auto menu = ctx->composition().back().menu;
+    for (size_t i = 0; i < menu->Prepare(10); ++i) {
+      texts.push_back(menu->GetCandidateAt(i)->text());
+    }
+    return texts;
+  }
+};
+
+TEST_F(RimeEngineTest, LazyLoading) {
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(CreateSchema(true));
+  EXPECT_EQ(0, TestTranslator::num_created);
+  EXPECT_EQ(0, TestFilter::num_created);
+
+  auto texts = Translate(engine.get(), "abc");
+  // `b` is not created for a segment without its tag.
+  EXPECT_EQ(1, TestTranslator::num_created);
+  EXPECT_EQ(1, TestTranslator::num_queries);
+  EXPECT_EQ(1, TestFilter::num_created);
+  EXPECT_EQ(1, TestFilter::num_applied);
+  ASSERT_EQ(2, texts.size());
+  EXPECT_EQ("a:abc", texts[0]);
+  EXPECT_EQ("f", texts[1]);
+
+  Translate(engine.get(), "abcd");
+  EXPECT_EQ(1, TestTranslator::num_created);
+  EXPECT_EQ(2, TestTranslator::num_queries);
+  EXPECT_EQ(1, TestFilter::num_created);
+}
+
+TEST_F(RimeEngineTest, SameResultsWithoutLazyLoading) {
+  the<Engine> lazy_engine(Engine::Create());
+  lazy_engine->ApplySchema(CreateSchema(true));
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(CreateSchema(false));
+  EXPECT_EQ(2, TestTranslator::num_created);
+  EXPECT_EQ(1, TestFilter::num_created);
+  for (const string input : {"a", "abc", "zyx"}) {
+    auto texts = Translate(engine.get(), input);
+    EXPECT_FALSE(texts.empty());
+    EXPECT_EQ(texts, Translate(lazy_engine.get(), input));
+  }
+}
+
+TEST_F(RimeEngineTest, SameResultsWithParallelTranslation) {
+  the<Engine> parallel_engine(Engine::Create());
+  parallel_engine->ApplySchema(CreateParallelSchema(true, false));
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(CreateParallelSchema(false, false));
+  vector<string> expected = {"a:abc", "b:abc", "c:abc", "d:abc", "f"};
+  EXPECT_EQ(expected, Translate(parallel_engine.get(), "abc"));
+  for (const string input : {"a", "abc", "zyx"}) {
+    auto texts = Translate(engine.get(), input);
+    EXPECT_FALSE(texts.empty());
+    EXPECT_EQ(texts, Translate(parallel_engine.get(), input));
+  }
+}
+
+TEST_F(RimeEngineTest, QueriesOtherTranslatorsFirst) {
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(CreateParallelSchema(true, true));
+  const auto engine_thread = std::this_thread::get_id();
+
+  // translators yet to be created are queried in turn, on the engine thread.
+  Translate(engine.get(), "abc");
+  ASSERT_EQ(4, TestTranslator::queries.size());
+  const char* name_spaces[] = {"a", "b", "c", "d"};
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(name_spaces[i], TestTranslator::queries[i].first);
+    EXPECT_EQ(engine_thread, TestTranslator::queries[i].second);
+  }
+
+  // then those not supporting concurrent queries go first.
+  TestTranslator::queries.clear();
+  vector<string> expected = {"a:abcd", "b:abcd", "c:abcd", "d:abcd", "f"};
+  EXPECT_EQ(expected, Translate(engine.get(), "abcd"));
+  ASSERT_EQ(4, TestTranslator::queries.size());
+  EXPECT_EQ("b", TestTranslator::queries[0].first);
+  EXPECT_EQ(engine_thread, TestTranslator::queries[0].second);
+  EXPECT_EQ("d", TestTranslator::queries[1].first);
+  EXPECT_EQ(engine_thread, TestTranslator::queries[1].second);
+  set<string> rest = {TestTranslator::queries[2].first,
+                           TestTranslator::queries[3].first};
+  EXPECT_EQ((set<string>{"a", "c"}), rest);
+}
+
+TEST_F(RimeEngineTest, SharesTranslationPool) {
+  ThreadPool* pool = Service::instance().translation_pool();
+  ASSERT_TRUE(pool != nullptr);
+  // at most 3 threads for the whole process.
+  EXPECT_LE(pool->size(), 3);
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(CreateParallelSchema(true, false));
+  the<Engine> other_engine(Engine::Create());
+  other_engine->ApplySchema(CreateParallelSchema(true, false));
+  Translate(engine.get(), "abc");
+  Translate(other_engine.get(), "abc");
+  EXPECT_EQ(pool, Service::instance().translation_pool());
+}
+
+// run with --gtest_also_run_disabled_tests to measure the cost of a keystroke,
+// from Engine::ProcessKey() to the first page of candidates.
+TEST_F(RimeEngineTest, DISABLED_KeystrokeBenchmark) {
+  constexpr int kRounds = 100;
+  constexpr int kPageSize = 10;
+  const string keys = "abcdefghij";
+  auto* config = new Config;
+  config->SetItem("engine/processors", MakeList({"speller"}));
+  config->SetItem("engine/segmentors", MakeList({"abc_segmentor"}));
+  config->SetItem("engine/translators",
+                  MakeList({"test_translator@a", "test_translator@b"}));
+  config->SetString("b/tag", "abc");
+  config->SetInt("a/candidates", 50);
+  config->SetInt("b/candidates", 50);
+  the<Engine> engine(Engine::Create());
+  engine->ApplySchema(new Schema("engine_test", config));
+  Context* ctx = engine->context();
+  BlockPool::Stats initial_stats = BlockPool::stats();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRounds; ++i) {
+    for (char key : keys) {
+      ASSERT_TRUE(engine->ProcessKey(KeyEvent(key, 0)));
+      ASSERT_TRUE(ctx->HasMenu());
+      auto menu = ctx->composition().back().menu;
+      ASSERT_EQ(kPageSize, menu->Prepare(kPageSize));
+    }
+    ctx->Clear();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  const BlockPool::Stats& stats = BlockPool::stats();
+  const size_t keystrokes = kRounds * keys.length();
+  std::cout << elapsed.count() / keystrokes << " us, "
+            << (stats.allocations - initial_stats.allocations) / keystrokes
+            << " pool allocations ("
+            << (stats.heap_allocations - initial_stats.heap_allocations) /
+                   keystrokes
+            << " from heap) per keystroke" << std::endl;
+}
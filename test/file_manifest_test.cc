@@ -0,0 +1,72 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/file_manifest.h>
+#include <rime/algo/utilities.h>
+
+using namespace rime;
+
+namespace fs = std::filesystem;
+
+// writes a file modified a minute ago, so that the manifest records it.
+static path WriteFile(const string& name, const string& content) {
+  path file_path(name);
+  {
+    std::ofstream out(file_path.c_str(), std::ios::binary);
+    out << content;
+  }
+  fs::last_write_time(file_path, fs::file_time_type::clock::now() -
+                                     std::chrono::minutes(1));
+  return file_path;
+}
+
+TEST(RimeFileManifestTest, ChecksumFromRecordedStamps) {
+  auto a = WriteFile("file_manifest_test_a.txt", "hello, world!\n");
+  auto b = WriteFile("file_manifest_test_b.txt", string(100000, 'x'));
+  auto manifest_path = path("file_manifest_test.txt");
+
+  ChecksumComputer expected(42);
+  expected.ProcessFile(a);
+  expected.ProcessFile(b);
+
+  FileManifest manifest;
+  manifest.Prefetch({a, b});
+  ChecksumComputer actual(42);
+  manifest.ProcessFile(a, &actual);
+  manifest.ProcessFile(b, &actual);
+  EXPECT_TRUE(manifest.modified());
+  EXPECT_EQ(expected.Checksum(), actual.Checksum());
+  EXPECT_EQ(Checksum(b), manifest.Checksum(b));
+
+  FileManifest::Stamp stamp;
+  ASSERT_TRUE(manifest.GetStamp(b, &stamp));
+  EXPECT_EQ(100000, stamp.size);
+  ASSERT_TRUE(manifest.Save(manifest_path));
+  EXPECT_FALSE(manifest.modified());
+
+  // same size and mtime, but different content: the recorded hash is used
+  // without reading the file again.
+  auto mtime = fs::last_write_time(b);
+  WriteFile(b.string(), string(100000, 'y'));
+  fs::last_write_time(b, mtime);
+  FileManifest reloaded;
+  ASSERT_TRUE(reloaded.Load(manifest_path));
+  FileManifest::Stamp reloaded_stamp;
+  ASSERT_TRUE(reloaded.GetStamp(b, &reloaded_stamp));
+  EXPECT_EQ(stamp.size, reloaded_stamp.size);
+  EXPECT_EQ(stamp.mtime, reloaded_stamp.mtime);
+  EXPECT_EQ(stamp.crc, reloaded_stamp.crc);
+  EXPECT_NE(Checksum(b), reloaded.Checksum(b));
+  EXPECT_FALSE(reloaded.modified());
+
+  for (const auto& file_path : {a, b, manifest_path}) {
+    fs::remove(file_path);
+  }
+}
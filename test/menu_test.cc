@@ -5,6 +5,7 @@
 // 2011-05-29 GONG Chen <chen.sst@gmail.com>
 //
 
+#include <random>
 #include <gtest/gtest.h>
 #include <rime/candidate.h>
 #include <rime/common.h>
@@ -77,3 +78,73 @@ TEST(RimeMenuTest, RecipeAlphaBeta) {
   the<Page> no_more_page(menu.CreatePage(5, 1));
   EXPECT_FALSE(bool(no_more_page));
 }
+
+// elects translations the way MergedTranslation does, scanning from the
+// first translation for every candidate.
+static vector<string> MergeByFullScan(vector<of<Translation>> translations) {
+  CandidateList no_candidates;
+  vector<string> texts;
+  while (!translations.empty()) {
+    size_t k = 0;
+    while (k + 1 < translations.size() &&
+           translations[k]->Compare(translations[k + 1], no_candidates) > 0) {
+      ++k;
+    }
+    texts.push_back(translations[k]->Peek()->text());
+    translations[k]->Next();
+    if (translations[k]->exhausted()) {
+      translations.erase(translations.begin() + k);
+    }
+  }
+  return texts;
+}
+
+TEST(RimeMenuTest, MergedTranslationOrder) {
+  std::mt19937 rng(42);
+  for (int round = 0; round < 20; ++round) {
+    vector<of<Translation>> translations[2];
+    for (int t = 0; t < 6; ++t) {
+      auto fifo = New<FifoTranslation>();
+      for (int i = 0, n = rng() % 8 + 1; i < n; ++i) {
+        auto cand = New<SimpleCandidate>(
+            "test", 0, rng() % 3 + 1,
+            std::to_string(t) + "." + std::to_string(i));
+        cand->set_quality(rng() % 5);
+        fifo->Append(cand);
+      }
+      translations[0].push_back(fifo);
+      auto copy = New<FifoTranslation>(*fifo);
+      translations[1].push_back(copy);
+    }
+    Menu menu;
+    for (const auto& translation : translations[0]) {
+      menu.AddTranslation(translation);
+    }
+    vector<string> texts;
+    size_t count = menu.Prepare(100);
+    for (size_t i = 0; i < count; ++i) {
+      texts.push_back(menu.GetCandidateAt(i)->text());
+    }
+    EXPECT_EQ(MergeByFullScan(translations[1]), texts);
+  }
+}
+
+TEST(RimeMenuTest, PrepareWithinBudget) {
+  Menu menu;
+  menu.AddTranslation(New<TranslationAlpha>());
+  menu.AddTranslation(New<TranslationBeta>());
+  Menu::Budget budget;
+  budget.max_candidates = 1;
+  EXPECT_EQ(1, menu.Prepare(3, budget));
+  EXPECT_FALSE(menu.exhausted());
+  // resumes from the last candidate prepared.
+  EXPECT_EQ(2, menu.Prepare(3, budget));
+  EXPECT_EQ(3, menu.Prepare(4, budget));
+  EXPECT_EQ("Beta-2", menu.GetCandidateAt(2)->text());
+  EXPECT_FALSE(menu.exhausted());
+  the<Page> page(menu.CreatePage(4, 0));
+  ASSERT_TRUE(bool(page));
+  EXPECT_TRUE(page->is_last_page);
+  EXPECT_EQ(4, page->candidates.size());
+  EXPECT_TRUE(menu.exhausted());
+}
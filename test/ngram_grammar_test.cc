@@ -0,0 +1,50 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/dict/ngram_db.h>
+#include <rime/gear/ngram_grammar.h>
+
+using namespace rime;
+
+static uint64_t NgramKey(const string& history, const string& word) {
+  return NgramDb::CombineKey(NgramDb::HashString(history),
+                             NgramDb::HashString(word));
+}
+
+TEST(RimeNgramGrammarTest, QueryLongestHistory) {
+  path file_path("ngram_grammar_test.ngram.bin");
+  {
+    NgramDb db(file_path);
+    db.Remove();
+    ASSERT_TRUE(db.Build({{NgramKey("好", "中國"), -2.0},
+                          {NgramKey("你好", "中國"), -1.0},
+                          {NgramKey("中國", "</s>"), -0.5}},
+                         2));
+    ASSERT_TRUE(db.Save());
+  }
+  auto db = New<NgramDb>(file_path);
+  ASSERT_TRUE(db->Load());
+  double score = 0.0;
+  EXPECT_TRUE(db->Lookup(NgramKey("好", "中國"), &score));
+  EXPECT_NEAR(-2.0, score, 0.05);
+  EXPECT_FALSE(db->Lookup(NgramKey("好", "人"), &score));
+
+  NgramGrammar grammar(db, nullptr);
+  EXPECT_NEAR(-1.0, grammar.Query("我說你好", "中國", false), 0.05);
+  EXPECT_NEAR(-2.0, grammar.Query("很好", "中國", false), 0.05);
+  EXPECT_NEAR(-1.5, grammar.Query("你好", "中國", true), 0.05);
+  EXPECT_EQ(Grammar::kPenalty, grammar.Query("你好", "人", false));
+
+  string word("中國");
+  const string* words[] = {&word, &word};
+  double scores[2];
+  grammar.QueryBatch("你好", words, 2, false, scores);
+  EXPECT_NEAR(-1.0, scores[1], 0.05);
+
+  db->Close();
+  db->Remove();
+}
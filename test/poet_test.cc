@@ -0,0 +1,241 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/component.h>
+#include <rime/config.h>
+#include <rime/language.h>
+#include <rime/registry.h>
+#include <rime/dict/vocabulary.h>
+#include <rime/gear/grammar.h>
+#include <rime/gear/poet.h>
+
+using namespace rime;
+
+namespace {
+
+// scores a word by the last character of its context, deterministically.
+class TestGrammar : public Grammar {
+ public:
+  double Query(const string& context, const string& word, bool is_rear) {
+    size_t h = std::hash<string>()(
+        (context.empty() ? string() : context.substr(context.length() - 1)) +
+        word);
+    return -double(h % 1000) / 100.0 - (is_rear ? 0.5 : 0.0);
+  }
+};
+
+class TestGrammarComponent : public Grammar::Component {
+ public:
+  Grammar* Create(Config* config) { return new TestGrammar; }
+};
+
+}  // namespace
+
+class RimePoetTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kSyllableLength = 3;
+
+  void TearDown() override { Registry::instance().Unregister("grammar"); }
+
+  void UseGrammar() {
+    Registry::instance().Register("grammar", new TestGrammarComponent);
+  }
+
+  // a word lattice on an input of `num_syllables` syllables, with words of
+  // one to four syllables starting at each syllable.
+  static WordLattice MakeWordLattice(size_t num_syllables) {
+    static const size_t kEntriesPerLength[] = {0, 24, 8, 3, 2};
+    WordLattice words;
+    for (size_t i = 0; i < num_syllables; ++i) {
+      for (size_t n = 1; n <= 4 && i + n <= num_syllables; ++n) {
+        for (size_t k = 0; k < kEntriesPerLength[n]; ++k) {
+          auto entry = New<DictEntry>();
+          // single characters recur at different positions.
+          entry->text = n == 1 ? "c" + std::to_string((i * 7 + k) % 40)
+                               : "w" + std::to_string(i) + "_" +
+                                     std::to_string(n) + "_" +
+                                     std::to_string(k);
+          entry->weight = -double(k) / n;
+          words.Add(i * kSyllableLength, (i + n) * kSyllableLength, entry);
+        }
+      }
+    }
+    words.Finish();
+    return words;
+  }
+
+  Language language_{"test"};
+  Config config_;
+};
+
+TEST_F(RimePoetTest, MakeSentence) {
+  UseGrammar();
+  Poet poet(&language_, &config_);
+  auto words = MakeWordLattice(8);
+  auto sentence = poet.MakeSentence(words, 8 * kSyllableLength, "");
+  ASSERT_TRUE(bool(sentence));
+  ASSERT_FALSE(sentence->empty());
+  EXPECT_EQ(8 * kSyllableLength, sentence->end());
+  size_t total = 0;
+  for (size_t length : sentence->word_lengths()) {
+    total += length;
+  }
+  EXPECT_EQ(8 * kSyllableLength, total);
+}
+
+TEST_F(RimePoetTest, LeftAssociateCompare) {
+  // two words of equal weight covering the same range: prefer fewer words,
+  // then shorter words to the left.
+  WordLattice words;
+  auto make_entry = [](const string& text) {
+    auto entry = New<DictEntry>();
+    entry->text = text;
+    return entry;
+  };
+  words.Add(0, 1, make_entry("a"));
+  words.Add(0, 2, make_entry("ab"));
+  words.Add(1, 3, make_entry("bc"));
+  words.Add(2, 3, make_entry("c"));
+  words.Finish();
+  Poet poet(&language_, &config_, Poet::LeftAssociateCompare);
+  auto sentence = poet.MakeSentence(words, 3, "");
+  ASSERT_TRUE(bool(sentence));
+  EXPECT_EQ("abc", sentence->text());
+  ASSERT_EQ(2, sentence->word_lengths().size());
+  EXPECT_EQ(2, sentence->word_lengths()[0]);
+}
+
+TEST_F(RimePoetTest, ResumeMakingSentence) {
+  for (bool with_grammar : {false, true}) {
+    if (with_grammar)
+      UseGrammar();
+    Poet poet(&language_, &config_);
+    for (size_t num_syllables = 1; num_syllables <= 8; ++num_syllables) {
+      auto words = MakeWordLattice(num_syllables);
+      size_t total_length = num_syllables * kSyllableLength;
+      if (num_syllables == 6) {
+        // an early edge changes, eg. by a user phrase.
+        ASSERT_EQ(kSyllableLength, words.edges()[0].end_pos);
+        words.entry(0)->weight = 1.0;
+      }
+      auto resumed = poet.MakeSentence(words, total_length, "");
+      Poet fresh_poet(&language_, &config_);
+      auto expected = fresh_poet.MakeSentence(words, total_length, "");
+      ASSERT_EQ(bool(expected), bool(resumed));
+      if (expected) {
+        EXPECT_EQ(expected->text(), resumed->text());
+        EXPECT_EQ(expected->weight(), resumed->weight());
+        EXPECT_EQ(expected->word_lengths(), resumed->word_lengths());
+      }
+    }
+  }
+}
+
+TEST_F(RimePoetTest, MakeSentences) {
+  // without grammar, weights add up along the path; compare with all paths.
+  auto words = MakeWordLattice(3);
+  size_t total_length = 3 * kSyllableLength;
+  map<string, double> best_weights;
+  std::function<void(size_t, string, double, size_t)> visit =
+      [&](size_t pos, string text, double weight, size_t word_count) {
+        if (pos == total_length) {
+          if (word_count > 1 && (!best_weights.count(text) ||
+                                 best_weights[text] < weight)) {
+            best_weights[text] = weight;
+          }
+          return;
+        }
+        auto edges = words.EdgesFrom(pos);
+        for (auto edge = edges.first; edge != edges.second; ++edge) {
+          for (size_t i = edge->begin; i < edge->end; ++i) {
+            const auto& entry = words.entry(i);
+            visit(edge->end_pos, text + entry->text,
+                  weight + entry->weight + Grammar::kPenalty, word_count + 1);
+          }
+        }
+      };
+  visit(0, "", 0.0, 0);
+  vector<double> expected_weights;
+  for (const auto& x : best_weights) {
+    expected_weights.push_back(x.second);
+  }
+  std::sort(expected_weights.rbegin(), expected_weights.rend());
+
+  Poet poet(&language_, &config_);
+  auto best = poet.MakeSentence(words, total_length, "");
+  auto translation = poet.MakeSentences(words, total_length, "", 5);
+  ASSERT_TRUE(bool(translation));
+  auto first = As<Sentence>(translation->Peek());
+  ASSERT_TRUE(bool(first));
+  EXPECT_EQ(best->text(), first->text());
+  EXPECT_EQ(5, first->start());
+  set<string> texts;
+  for (size_t k = 0; k < 50; ++k) {
+    auto sentence = As<Sentence>(translation->Peek());
+    ASSERT_TRUE(bool(sentence));
+    EXPECT_TRUE(texts.insert(sentence->text()).second);
+    EXPECT_NEAR(expected_weights[k], sentence->weight(), 1e-9);
+    translation->Next();
+  }
+}
+
+TEST_F(RimePoetTest, MakeSentencesWithGrammar) {
+  UseGrammar();
+  Poet poet(&language_, &config_, Poet::LeftAssociateCompare);
+  auto words = MakeWordLattice(6);
+  size_t total_length = 6 * kSyllableLength;
+  auto best = poet.MakeSentence(words, total_length, "");
+  // resumes from the lines made for the best sentence.
+  auto translation = poet.MakeSentences(words, total_length, "");
+  ASSERT_TRUE(bool(translation));
+  EXPECT_EQ(best->text(), translation->Peek()->text());
+  Poet fresh_poet(&language_, &config_, Poet::LeftAssociateCompare);
+  auto expected = fresh_poet.MakeSentences(words, total_length, "");
+  ASSERT_TRUE(bool(expected));
+  set<string> texts;
+  for (size_t k = 0; k < 20 && !translation->exhausted(); ++k) {
+    auto sentence = As<Sentence>(translation->Peek());
+    EXPECT_EQ(total_length, sentence->end());
+    EXPECT_TRUE(texts.insert(sentence->text()).second);
+    auto expected_sentence = As<Sentence>(expected->Peek());
+    ASSERT_TRUE(bool(expected_sentence));
+    EXPECT_EQ(expected_sentence->text(), sentence->text()) << "at " << k;
+    EXPECT_EQ(expected_sentence->weight(), sentence->weight()) << "at " << k;
+    translation->Next();
+    expected->Next();
+  }
+  EXPECT_EQ(20, texts.size());
+  // the lattice in use by the translation is left intact.
+  auto again = poet.MakeSentence(MakeWordLattice(7), 7 * kSyllableLength, "");
+  ASSERT_TRUE(bool(again));
+  EXPECT_FALSE(translation->exhausted());
+}
+
+// run with --gtest_also_run_disabled_tests to measure sentence making speed.
+TEST_F(RimePoetTest, DISABLED_Benchmark) {
+  UseGrammar();
+  Poet poet(&language_, &config_, Poet::LeftAssociateCompare);
+  constexpr int kRounds = 200;
+  for (size_t num_syllables : {7, 10, 13}) {
+    auto words = MakeWordLattice(num_syllables);
+    size_t total_length = num_syllables * kSyllableLength;
+    an<Sentence> sentence;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+      sentence = poet.MakeSentence(words, total_length, "");
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(bool(sentence));
+    std::cout << total_length << " chars: " << elapsed.count() / kRounds
+              << " us per sentence; " << sentence->text() << std::endl;
+  }
+}
@@ -0,0 +1,85 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/retention_cache.h>
+
+using namespace rime;
+
+static path WriteFile(const string& name, size_t size) {
+  path file_path(name);
+  std::ofstream out(file_path.c_str(), std::ios::binary);
+  out << string(size, 'x');
+  return file_path;
+}
+
+TEST(RimeRetentionCacheTest, EvictsLeastRecentlyUsed) {
+  auto a = WriteFile("retention_cache_test_a.bin", 100);
+  auto b = WriteFile("retention_cache_test_b.bin", 100);
+  auto c = WriteFile("retention_cache_test_c.bin", 100);
+  RetentionCache cache;
+  cache.set_budget(250);
+  weak<int> wa, wb, wc;
+  {
+    auto ra = New<int>(1), rb = New<int>(2), rc = New<int>(3);
+    wa = ra, wb = rb, wc = rc;
+    cache.Retain(ra, a);
+    cache.Retain(rb, b);
+    cache.Retain(ra, a);  // touch a, so that b is the least recently used
+    cache.Retain(rc, c);
+  }
+  EXPECT_FALSE(wa.expired());
+  EXPECT_TRUE(wb.expired());
+  EXPECT_FALSE(wc.expired());
+  auto stats = cache.stats();
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(2, stats.retained_count);
+  EXPECT_EQ(200, stats.retained_size);
+
+  cache.Release(a);
+  EXPECT_TRUE(wa.expired());
+  cache.set_budget(0);
+  EXPECT_TRUE(wc.expired());
+  EXPECT_EQ(0, cache.stats().retained_size);
+
+  for (const auto& file_path : {a, b, c}) {
+    std::filesystem::remove(file_path);
+  }
+}
+
+TEST(RimeRetentionCacheTest, CountsHitsServedByRetention) {
+  auto a = WriteFile("retention_cache_test_a.bin", 100);
+  auto empty = WriteFile("retention_cache_test_empty.bin", 0);
+  RetentionCache cache;
+  cache.set_budget(1000);
+  auto resource = New<int>(1);
+  cache.RecordLookup(a, 0);
+  cache.Retain(resource, a);
+  // still in use by another session.
+  auto shared = resource;
+  cache.RecordLookup(a, shared.use_count());
+  shared.reset();
+  cache.RecordLookup(a, resource.use_count());
+  auto stats = cache.stats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(1, stats.misses);
+
+  weak<int> not_built;
+  {
+    auto resource = New<int>(2);
+    not_built = resource;
+    cache.Retain(resource, empty);
+    cache.Retain(resource, path("retention_cache_test_missing.bin"));
+  }
+  EXPECT_TRUE(not_built.expired());
+  EXPECT_EQ(1, cache.stats().retained_count);
+
+  for (const auto& file_path : {a, empty}) {
+    std::filesystem::remove(file_path);
+  }
+}
@@ -203,3 +203,30 @@ TEST_F(RimeTableTest, QueryWithSyllableGraph) {
   EXPECT_STREQ("lia", Text(result[4].front()).c_str());
   EXPECT_FALSE(result[4].front().Next());
 }
+
+TEST(RimeTableTextFlagsTest, ExtendedCjk) {
+  rime::Table table(rime::path{"table_text_flags_test.bin"});
+  table.Remove();
+  rime::Syllabary syll{"zhong"};
+  rime::Vocabulary voc;
+  for (const char* text : {"\xe4\xb8\xad",      // 中
+                           "\xe3\x90\x80"}) {  // U+3400, in Extension A
+    auto d = rime::New<rime::ShortDictEntry>();
+    d->code.push_back(0);
+    d->text = text;
+    voc[0].entries.push_back(d);
+  }
+  ASSERT_TRUE(table.Build(syll, voc, 2));
+  ASSERT_TRUE(table.Save());
+  ASSERT_TRUE(table.Load());
+  rime::TableAccessor a = table.QueryWords(0);
+  ASSERT_EQ(2, a.remaining());
+  for (; !a.exhausted(); a.Next()) {
+    uint8_t flags = 0;
+    ASSERT_TRUE(table.GetEntryTextFlags(*a.entry(), &flags));
+    bool extended = table.GetEntryText(*a.entry()) != "\xe4\xb8\xad";
+    EXPECT_EQ(extended, bool(flags & rime::table::kExtendedCjk));
+  }
+  table.Close();
+  table.Remove();
+}
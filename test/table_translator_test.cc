@@ -0,0 +1,187 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <algorithm>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/config.h>
+#include <rime/context.h>
+#include <rime/engine.h>
+#include <rime/schema.h>
+#include <rime/segmentation.h>
+#include <rime/service.h>
+#include <rime/ticket.h>
+#include <rime/translation.h>
+#include <rime/dict/user_dictionary.h>
+#include <rime/gear/poet.h>
+#include <rime/gear/table_translator.h>
+#include <rime/gear/unity_table_encoder.h>
+
+using namespace rime;
+
+namespace {
+
+class TestTableTranslator : public TableTranslator {
+ public:
+  using TableTranslator::TableTranslator;
+
+  // validates the memo for `input`, then tells whether `code` is memoized.
+  bool IsMemoized(const string& input, const string& code) {
+    ValidateLookupMemo(input, 0, false);
+    return lookup_memo_.user_words.count(code) > 0;
+  }
+  void Memoize(const string& code) { lookup_memo_.user_words[code]; }
+  const TableLookupMemo& lookup_memo() const { return lookup_memo_; }
+};
+
+}  // namespace
+
+class RimeTableTranslatorTest : public ::testing::Test {
+ protected:
+  static constexpr const char* kUserDict = "table_translator_test";
+
+  void SetUp() override {
+    auto* config = new Config;
+    config->SetString("translator/user_dict", kUserDict);
+    config->SetString("translator/enable_sentence", "false");
+    config->SetString("translator/enable_charset_filter", "true");
+    engine_.reset(Engine::Create());
+    engine_->ApplySchema(new Schema("table_translator_test", config));
+  }
+
+  void TearDown() override {
+    engine_.reset();
+    Service::instance().retention().Clear();
+    std::filesystem::remove_all(string(kUserDict) + ".userdb");
+  }
+
+  static vector<string> Query(Translator* translator, const string& input) {
+    Segment segment(0, input.length());
+    segment.tags.insert("abc");
+    vector<string> texts;
+    auto translation = translator->Query(input, segment);
+    for (; translation && !translation->exhausted(); translation->Next()) {
+      texts.push_back(translation->Peek()->text());
+    }
+    return texts;
+  }
+
+  static bool AddUserPhrase(UserDictionary* user_dict,
+                            const string& text,
+                            const string& code = "abc ") {
+    DictEntry entry;
+    entry.text = text;
+    entry.custom_code = code;
+    return user_dict->UpdateEntry(entry, 1);
+  }
+
+  the<Engine> engine_;
+};
+
+TEST_F(RimeTableTranslatorTest, LookupMemo) {
+  TestTableTranslator translator(Ticket(engine_.get(), "translator"));
+  ASSERT_TRUE(translator.user_dict() && translator.user_dict()->loaded());
+
+  EXPECT_FALSE(translator.IsMemoized("ab", "ab "));
+  translator.Memoize("ab ");
+  // reused as the input grows or shrinks at the end.
+  EXPECT_TRUE(translator.IsMemoized("abc", "ab "));
+  EXPECT_TRUE(translator.IsMemoized("a", "ab "));
+
+  // a user phrase is committed.
+  ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "x"));
+  EXPECT_FALSE(translator.IsMemoized("ab", "ab "));
+
+  // another translator, eg. of another session, shares the user db.
+  translator.Memoize("ab ");
+  EXPECT_TRUE(translator.IsMemoized("ab", "ab "));
+  TestTableTranslator other(Ticket(engine_.get(), "translator"));
+  ASSERT_NE(translator.user_dict(), other.user_dict());
+  ASSERT_TRUE(AddUserPhrase(other.user_dict(), "y"));
+  EXPECT_FALSE(translator.IsMemoized("ab", "ab "));
+}
+
+TEST_F(RimeTableTranslatorTest, FiltersUserPhrasesByCharset) {
+  // U+20000, in CJK Unified Ideographs Extension B.
+  const string kExtendedPhrase = "\xf0\xa0\x80\x80";
+  Context* ctx = engine_->context();
+  for (const char* enable_completion : {"true", "false"}) {
+    engine_->schema()->config()->SetString("translator/enable_completion",
+                                           enable_completion);
+    TestTableTranslator translator(Ticket(engine_.get(), "translator"));
+    ASSERT_TRUE(AddUserPhrase(translator.user_dict(), kExtendedPhrase));
+    ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "x"));
+
+    ctx->set_option("extended_charset", false);
+    vector<string> expected = {"x"};
+    EXPECT_EQ(expected, Query(&translator, "abc"));
+
+    ctx->set_option("extended_charset", true);
+    auto texts = Query(&translator, "abc");
+    std::sort(texts.begin(), texts.end());
+    expected = {kExtendedPhrase, "x"};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, texts);
+  }
+}
+
+TEST_F(RimeTableTranslatorTest, NoConcurrentQueryInSession) {
+  TestTableTranslator translator(Ticket(engine_.get(), "translator"));
+  EXPECT_TRUE(translator.concurrent_query());
+  // a session learning user phrases is not shared with other threads.
+  ASSERT_TRUE(translator.StartSession());
+  EXPECT_FALSE(translator.concurrent_query());
+  translator.FinishSession();
+  EXPECT_TRUE(translator.concurrent_query());
+}
+
+TEST_F(RimeTableTranslatorTest, MemoizesPrefixPhrases) {
+  engine_->schema()->config()->SetString("translator/enable_sentence", "true");
+  TestTableTranslator translator(Ticket(engine_.get(), "translator"));
+  ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "x"));
+  translator.MakeSentence("abc", 0, true);
+  const auto& memo = translator.lookup_memo();
+  // looked up once for both the sentence and the phrases to compose it.
+  ASSERT_EQ(1, memo.user_words.count("abc"));
+  EXPECT_EQ(1, memo.user_words.at("abc").entries.size());
+  ASSERT_EQ(1, memo.user_prefix_words.count("abc"));
+  auto uter = memo.user_prefix_words.at("abc");
+  ASSERT_FALSE(uter.exhausted());
+  EXPECT_EQ("x", uter.Peek()->text);
+
+  // then kept as the input grows.
+  translator.MakeSentence("abca", 0, true);
+  EXPECT_EQ(1, memo.user_prefix_words.count("abc"));
+  EXPECT_FALSE(memo.user_prefix_words.at("abc").exhausted());
+}
+
+TEST_F(RimeTableTranslatorTest, MakesNextBestSentences) {
+  Config* config = engine_->schema()->config();
+  config->SetString("translator/enable_sentence", "true");
+  config->SetInt("translator/max_homographs", 2);
+  for (int max_sentences : {1, 3}) {
+    config->SetInt("translator/max_sentences", max_sentences);
+    TestTableTranslator translator(Ticket(engine_.get(), "translator"));
+    ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "x", "ab "));
+    ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "y", "ab "));
+    ASSERT_TRUE(AddUserPhrase(translator.user_dict(), "z", "c "));
+    vector<string> sentences;
+    auto translation = translator.MakeSentence("abc", 0, true);
+    for (; translation && !translation->exhausted(); translation->Next()) {
+      auto cand = translation->Peek();
+      if (cand->type() == "sentence")
+        sentences.push_back(cand->text());
+    }
+    if (max_sentences == 1) {
+      ASSERT_EQ(1, sentences.size());
+    } else {
+      // of the same lattice, there are only two.
+      std::sort(sentences.begin(), sentences.end());
+      EXPECT_EQ((vector<string>{"xz", "yz"}), sentences);
+    }
+  }
+}
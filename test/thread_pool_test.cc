@@ -0,0 +1,41 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <atomic>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/thread_pool.h>
+
+using namespace rime;
+
+TEST(RimeThreadPoolTest, PostTasks) {
+  std::atomic<int> count{0};
+  vector<std::future<int>> results;
+  {
+    ThreadPool pool(2);
+    EXPECT_EQ(2, pool.size());
+    for (int i = 0; i < 10; ++i) {
+      results.push_back(pool.Post([i, &count] {
+        ++count;
+        return i * i;
+      }));
+    }
+    EXPECT_EQ(81, results.back().get());
+  }
+  // queued tasks are finished before the pool is destroyed.
+  EXPECT_EQ(10, count);
+  EXPECT_EQ(4, results[2].get());
+}
+
+TEST(RimeThreadPoolTest, RunInTurnWithoutThreads) {
+  ThreadPool pool(0);
+  int value = 0;
+  auto result = pool.Post([&value] { return ++value; });
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(1, result.get());
+  auto failure = pool.Post([]() -> int { throw std::runtime_error("oops"); });
+  EXPECT_THROW(failure.get(), std::runtime_error);
+}
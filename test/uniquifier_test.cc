@@ -0,0 +1,69 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <chrono>
+#include <iostream>
+#include <gtest/gtest.h>
+#include <rime/block_pool.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/menu.h>
+#include <rime/ticket.h>
+#include <rime/translation.h>
+#include <rime/gear/uniquifier.h>
+
+using namespace rime;
+
+// `num_candidates` candidates, each text occurring `repeat` times in a row.
+static an<Translation> MakeTranslation(size_t num_candidates, size_t repeat) {
+  auto translation = New<FifoTranslation>();
+  for (size_t i = 0; i < num_candidates; ++i) {
+    translation->Append(NewPooled<SimpleCandidate>(
+        "test", 0, 1, "text" + std::to_string(i / repeat),
+        "comment" + std::to_string(i)));
+  }
+  return translation;
+}
+
+TEST(RimeUniquifierTest, MergesCandidatesOfSameText) {
+  Uniquifier uniquifier{Ticket()};
+  Menu menu;
+  menu.AddTranslation(MakeTranslation(9, 3));
+  menu.AddFilter(&uniquifier);
+  EXPECT_EQ(3, menu.Prepare(10));
+  for (size_t i = 0; i < 3; ++i) {
+    auto cand = As<UniquifiedCandidate>(menu.GetCandidateAt(i));
+    ASSERT_TRUE(bool(cand));
+    EXPECT_EQ("text" + std::to_string(i), cand->text());
+    EXPECT_EQ(3, cand->items().size());
+  }
+}
+
+// run with --gtest_also_run_disabled_tests to measure uniquification speed.
+TEST(RimeUniquifierTest, DISABLED_Benchmark) {
+  constexpr size_t kNumCandidates = 1000;
+  constexpr int kRounds = 100;
+  Uniquifier uniquifier{Ticket()};
+  BlockPool::Stats initial_stats = BlockPool::stats();
+  auto start = std::chrono::steady_clock::now();
+  size_t count = 0;
+  for (int i = 0; i < kRounds; ++i) {
+    Menu menu;
+    menu.AddTranslation(MakeTranslation(kNumCandidates, 2));
+    menu.AddFilter(&uniquifier);
+    count = menu.Prepare(kNumCandidates);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  const BlockPool::Stats& stats = BlockPool::stats();
+  EXPECT_EQ(kNumCandidates / 2, count);
+  std::cout << kNumCandidates << " candidates: " << elapsed.count() / kRounds
+            << " us, "
+            << (stats.allocations - initial_stats.allocations) / kRounds
+            << " allocations ("
+            << (stats.heap_allocations - initial_stats.heap_allocations) /
+                   kRounds
+            << " from heap) per menu" << std::endl;
+}
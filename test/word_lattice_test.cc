@@ -0,0 +1,41 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/gear/word_lattice.h>
+
+using namespace rime;
+
+static an<DictEntry> MakeEntry(const string& text) {
+  auto entry = New<DictEntry>();
+  entry->text = text;
+  return entry;
+}
+
+TEST(RimeWordLatticeTest, EdgesByStartAndEndPosition) {
+  WordLattice words(2);
+  EXPECT_TRUE(words.Add(0, 2, MakeEntry("ab")));
+  EXPECT_TRUE(words.Add(0, 1, MakeEntry("a")));
+  EXPECT_TRUE(words.Add(0, 2, MakeEntry("AB")));
+  EXPECT_TRUE(words.IsFull(0, 2));
+  EXPECT_FALSE(words.Add(0, 2, MakeEntry("aB")));
+  EXPECT_TRUE(words.Add(1, 3, MakeEntry("bc")));
+  EXPECT_EQ(2, words.CountEntries(0, 2));
+  words.Finish();
+
+  ASSERT_EQ(3, words.edges().size());
+  EXPECT_EQ(4, words.num_positions());
+  const auto* edge = words.FindEdge(0, 2);
+  ASSERT_TRUE(edge != nullptr);
+  ASSERT_EQ(2, edge->size());
+  EXPECT_EQ("ab", words.entry(edge->begin)->text);
+  EXPECT_EQ("AB", words.entry(edge->begin + 1)->text);
+  EXPECT_EQ("a", words.entry(words.FindEdge(0, 1)->begin)->text);
+  EXPECT_EQ(nullptr, words.FindEdge(1, 2));
+  auto edges = words.EdgesFrom(0);
+  EXPECT_EQ(2, edges.second - edges.first);
+  EXPECT_EQ(1, edges.first->end_pos);
+}
@@ -0,0 +1,124 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utf8.h>
+#include <rime/common.h>
+#include <rime/setup.h>
+#include <rime/dict/ngram_db.h>
+#include "codepage.h"
+
+// usage:
+//   rime_grammar_compiler <counts-file> <output-file>
+// example:
+//   rime_grammar_compiler zh-hant.counts.txt zh-hant.ngram.bin
+//
+// each line of the counts file lists the words of an n-gram, separated by
+// spaces, and its count after a tab:
+//   你好	1200
+//   你好 中國	35
+//   你好 中國 人	20
+//   人 </s>	300
+// an n-gram scores log(count(n-gram) / count(history)), where the count of
+// the history is given by its own line, or else summed over the n-grams
+// following it. "</s>" marks the end of a sentence.
+
+using namespace rime;
+
+static string JoinWords(const vector<string>& words, size_t n, char sep) {
+  string result;
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0 && sep)
+      result += sep;
+    result += words[i];
+  }
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned int codepage = SetConsoleOutputCodePage();
+  if (argc != 3) {
+    std::cout << "usage: rime_grammar_compiler <counts-file> <output-file>"
+              << std::endl;
+    SetConsoleOutputCodePage(codepage);
+    return 1;
+  }
+  SetupLogging("rime.tools");
+
+  std::ifstream fin(argv[1]);
+  if (!fin) {
+    std::cerr << "error opening counts file: " << argv[1] << std::endl;
+    SetConsoleOutputCodePage(codepage);
+    return 1;
+  }
+  // n-grams by their words joined with spaces.
+  map<string, double> counts;
+  vector<pair<vector<string>, double>> ngrams;
+  string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    size_t tab = line.find('\t');
+    double count = 0.0;
+    if (tab == string::npos ||
+        !(std::istringstream(line.substr(tab + 1)) >> count) || count <= 0) {
+      std::cerr << "invalid line: " << line << std::endl;
+      continue;
+    }
+    std::istringstream iss(line.substr(0, tab));
+    vector<string> words;
+    string word;
+    while (iss >> word)
+      words.push_back(word);
+    if (words.empty())
+      continue;
+    counts[JoinWords(words, words.size(), ' ')] += count;
+    if (words.size() > 1)
+      ngrams.emplace_back(std::move(words), count);
+  }
+
+  map<string, double> continuations;
+  for (const auto& ngram : ngrams) {
+    const auto& words = ngram.first;
+    continuations[JoinWords(words, words.size() - 1, ' ')] += ngram.second;
+  }
+  // the text of a history may be shared by different sequences of words;
+  // keep the most probable continuation.
+  map<uint64_t, double> scores;
+  uint32_t max_history_length = 0;
+  for (const auto& ngram : ngrams) {
+    const auto& words = ngram.first;
+    string history_key = JoinWords(words, words.size() - 1, ' ');
+    auto found = counts.find(history_key);
+    double history_count =
+        found != counts.end() ? found->second : continuations[history_key];
+    double score = std::log(ngram.second / history_count);
+    string history = JoinWords(words, words.size() - 1, 0);
+    uint32_t history_length = static_cast<uint32_t>(
+        utf8::unchecked::distance(history.c_str(),
+                                  history.c_str() + history.length()));
+    max_history_length = (std::max)(max_history_length, history_length);
+    uint64_t key = NgramDb::CombineKey(NgramDb::HashString(history),
+                                       NgramDb::HashString(words.back()));
+    auto inserted = scores.emplace(key, score);
+    if (!inserted.second && inserted.first->second < score)
+      inserted.first->second = score;
+  }
+
+  NgramDb db{path(argv[2])};
+  db.Remove();
+  vector<pair<uint64_t, double>> entries(scores.begin(), scores.end());
+  if (!db.Build(entries, max_history_length) || !db.Save()) {
+    std::cerr << "error building grammar: " << argv[2] << std::endl;
+    SetConsoleOutputCodePage(codepage);
+    return 1;
+  }
+  std::cout << "compiled " << entries.size() << " n-grams into " << argv[2]
+            << std::endl;
+  SetConsoleOutputCodePage(codepage);
+  return 0;
+}